@@ -1,48 +1,47 @@
 // File: StatsManager.cpp
 #include "StatsManager.h"
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
-
-// Helper: stringify a FieldValue
-static std::string fvToString(const FieldValue &fv) {
-    if (std::holds_alternative<int32_t>(fv))
-        return std::to_string(std::get<int32_t>(fv));
-    else
-        return std::get<std::string>(fv);
-}
+#include <string_view>
 
 StatsManager::StatsManager(StorageEngine &storage, Catalog &catalog)
   : storage_(storage), catalog_(catalog) {}
 
 void StatsManager::analyzeTable(const std::string &tableName) {
-    // 1) Fetch schema & all RIDs
+    // 1) Fetch schema
     Schema schema = catalog_.getTableSchema(tableName);
-    auto rids = storage_.scanTable(tableName);
-
-    // 2) Count rows
-    int64_t rowCount = static_cast<int64_t>(rids.size());
-
-    // 3) Prepare per‐column distinct counters
-    std::unordered_map<std::string, std::unordered_set<std::string>> distinctVals;
-    for (int i = 0; i < schema.numColumns(); ++i)
-        distinctVals[schema.getColumn(i).name] = {};
 
-    // 4) Scan each record
-    for (auto &rid : rids) {
-        auto row = storage_.getRecord(tableName, rid);
+    // 2) Prepare per‐column distinct sets. Fields are read in place off the
+    //    scanned pages; a string is copied (into `seen`) only the first time
+    //    it shows up, and the set holds views of those copies.
+    std::vector<std::unordered_set<int32_t>> distinctInts(schema.numColumns());
+    std::vector<std::unordered_set<std::string_view>> distinctStrs(schema.numColumns());
+    std::deque<std::string> seen;
+
+    // 3) Stream the table (through the bulk ring) and count rows
+    int64_t rowCount = 0;
+    for (auto cursor = storage_.openScan(tableName); cursor.next(); ++rowCount) {
+        RecordView rec = cursor.view();
         for (int i = 0; i < schema.numColumns(); ++i) {
-            const auto &colName = schema.getColumn(i).name;
-            distinctVals[colName].insert(fvToString(row[i]));
+            if (rec.type(i) == DataType::INT) {
+                distinctInts[i].insert(rec.getInt(i));
+            } else {
+                std::string_view s = rec.getString(i);
+                if (!distinctStrs[i].count(s))
+                    distinctStrs[i].insert(seen.emplace_back(s));
+            }
         }
     }
 
-    // 5) Build a simple map of distinct‐value counts
+    // 4) Build a simple map of distinct‐value counts
     std::unordered_map<std::string,int64_t> distinctCounts;
-    for (auto &p : distinctVals) {
-        distinctCounts[p.first] = static_cast<int64_t>(p.second.size());
+    for (int i = 0; i < schema.numColumns(); ++i) {
+        distinctCounts[schema.getColumn(i).name] =
+            static_cast<int64_t>(distinctInts[i].size() + distinctStrs[i].size());
     }
 
-    // 6) Push into the catalog
+    // 5) Push into the catalog
     catalog_.updateTableStats(tableName, rowCount, distinctCounts);
 }
@@ -1,5 +1,6 @@
 // File: WALManager.cpp
 #include "WALManager.h"
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include <filesystem>
@@ -42,6 +43,23 @@ void WALManager::logInsert(int64_t tx, const std::string &tbl,
     logOut_ << "\n";
 }
 
+void WALManager::logInsertPage(int64_t tx, const std::string &tbl,
+                               const RecordID &first,
+                               std::vector<std::vector<FieldValue>>::const_iterator begin,
+                               std::vector<std::vector<FieldValue>>::const_iterator end)
+{
+    if (begin == end) return;
+    std::lock_guard guard(latch_);
+    // Rows share a width, so they are written flat after the column count
+    logOut_ << "INSERT_PAGE," << tx << "," << tbl
+            << "," << first.pageId << "," << first.slotId
+            << "," << begin->size();
+    for (auto row = begin; row != end; ++row)
+        for (auto &v : *row)
+            logOut_ << "," << fvToString(v);
+    logOut_ << "\n";
+}
+
 void WALManager::logDelete(int64_t tx, const std::string &tbl,
                            const RecordID &rid,
                            const std::vector<FieldValue> &ov)
@@ -129,6 +147,17 @@ void WALManager::recover(StorageEngine &storage) {
                 nv.push_back(parseFV(parts[i]));
             records.push_back({ LogOp::INSERT, tx, tbl, rid, {}, nv });
         }
+        else if (op=="INSERT_PAGE") {
+            std::size_t ncols = std::stoul(parts[5]);
+            std::vector<std::vector<FieldValue>> rows;
+            for (size_t i=6;ncols>0 && i+ncols<=parts.size();i+=ncols) {
+                std::vector<FieldValue> row;
+                for (size_t c=0;c<ncols;c++)
+                    row.push_back(parseFV(parts[i+c]));
+                rows.push_back(std::move(row));
+            }
+            records.push_back({ LogOp::INSERT_PAGE, tx, tbl, rid, {}, {}, std::move(rows) });
+        }
         else if (op=="DELETE") {
             std::vector<FieldValue> ov;
             for (size_t i=5;i<parts.size();i++)
@@ -160,13 +189,35 @@ void WALManager::recover(StorageEngine &storage) {
         if (rec.op==LogOp::ABORT)    aborted.insert(rec.txId);
     }
 
-    // 3) REDO committed operations (in log order)
-    for (auto &rec : records) {
+    // 3) REDO committed operations (in log order), reading the pages of
+    //    the next REDO_PREFETCH_DEPTH records in the background
+    auto isRedo = [&](const LogRecord &rec) {
+        return committed.count(rec.txId) &&
+               (rec.op == LogOp::INSERT || rec.op == LogOp::INSERT_PAGE ||
+                rec.op == LogOp::DELETE || rec.op == LogOp::UPDATE);
+    };
+    std::size_t ahead = 0;
+    auto prefetchUpTo = [&](std::size_t end) {
+        for (; ahead < std::min(end, records.size()); ++ahead) {
+            if (isRedo(records[ahead]))
+                storage.prefetchForRedo(records[ahead].table, records[ahead].rid);
+        }
+    };
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        prefetchUpTo(i + REDO_PREFETCH_DEPTH);
+        auto &rec = records[i];
         if (!committed.count(rec.txId)) continue;
         switch (rec.op) {
           case LogOp::INSERT:
             storage.redoInsert(rec.table, rec.rid, rec.newValues);
             break;
+          case LogOp::INSERT_PAGE:
+            for (std::size_t r = 0; r < rec.rows.size(); ++r) {
+                RecordID rid = rec.rid;
+                rid.slotId += r;
+                storage.redoInsert(rec.table, rid, rec.rows[r]);
+            }
+            break;
           case LogOp::DELETE:
             storage.redoDelete(rec.table, rec.rid);
             break;
@@ -187,6 +238,13 @@ void WALManager::recover(StorageEngine &storage) {
             // undo insert = delete
             storage.redoDelete(rec.table, rec.rid);
             break;
+          case LogOp::INSERT_PAGE:
+            for (std::size_t r = rec.rows.size(); r-- > 0;) {
+                RecordID rid = rec.rid;
+                rid.slotId += r;
+                storage.redoDelete(rec.table, rid);
+            }
+            break;
           case LogOp::DELETE:
             // undo delete = re-insert old values
             storage.redoInsert(rec.table, rec.rid, rec.oldValues);
@@ -199,10 +257,13 @@ void WALManager::recover(StorageEngine &storage) {
         }
     }
 
-    // 5) Truncate the log
+    // 5) Make the replayed pages durable before the log is dropped
+    storage.checkpoint();
+
+    // 6) Truncate the log
     std::ofstream trunc(logFile_, std::ios::trunc);
     trunc.close();
 
-    // reopen for appending
+    // 7) reopen for appending
     logOut_.open(logFile_, std::ios::app);
 }
@@ -10,7 +10,7 @@
 #include "StorageEngine.h"    // for RecordID, FieldValue
 
 /// Log‐record types
-enum class LogOp { INSERT, DELETE, UPDATE, COMMIT, ABORT };
+enum class LogOp { INSERT, INSERT_PAGE, DELETE, UPDATE, COMMIT, ABORT };
 
 struct LogRecord {
     LogOp               op;
@@ -19,6 +19,7 @@ struct LogRecord {
     RecordID            rid;
     std::vector<FieldValue> oldValues;  // for DELETE & UPDATE
     std::vector<FieldValue> newValues;  // for INSERT & UPDATE
+    std::vector<std::vector<FieldValue>> rows = {};  // for INSERT_PAGE, from rid on
 };
 
 class WALManager {
@@ -31,6 +32,14 @@ public:
                    const RecordID &rid,
                    const std::vector<FieldValue> &newValues);
 
+    /// One record for rows bulk-inserted into consecutive slots of a page,
+    /// starting at firstRid
+    void logInsertPage(int64_t txId,
+                       const std::string &tableName,
+                       const RecordID &firstRid,
+                       std::vector<std::vector<FieldValue>>::const_iterator begin,
+                       std::vector<std::vector<FieldValue>>::const_iterator end);
+
     void logDelete(int64_t txId,
                    const std::string &tableName,
                    const RecordID &rid,
@@ -52,6 +61,9 @@ public:
     void recover(StorageEngine &storage);
 
 private:
+    // Log records whose pages are prefetched ahead of the redo pass
+    static constexpr std::size_t REDO_PREFETCH_DEPTH = 32;
+
     std::mutex       latch_;
     std::string      logFile_;
     std::ofstream    logOut_;
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cstring>
 #include "BufferManager.h"
+#include "PageGuard.h"
 
 // A simple B+ tree storing Key->Value mappings in fixed-size pages
 // Splits on insert; delete only removes from leaf (no rebalance).
@@ -19,6 +20,13 @@ public:
 
     // Insert or update a key/value
     void insert(const Key &key, const Value &value);
+    // Inserts many entries at once. The entries are sorted first (for a
+    // repeated key the last entry wins, as with insert). An empty tree is
+    // built bottom-up: leaves are filled left to right to BULK_FILL keys,
+    // then each internal level over the one below, writing every node
+    // once. A tree that already holds keys gets them as ordinary inserts
+    // in key order, which touches each leaf once.
+    void bulkLoad(std::vector<std::pair<Key, Value>> entries);
     // Remove a key (only from leaf, may underflow)
     bool remove(const Key &key);
     // Find a key's value; returns true if found
@@ -27,22 +35,27 @@ public:
     std::vector<Value> rangeScan(const Key &low, const Key &high) const;
 
 private:
+    static constexpr int HEADER_PAGE = 0;
+    static constexpr int MAX_KEYS = 128;
+    // Bulk-built nodes are left 10% empty so later inserts do not split
+    // every node straight away
+    static constexpr int BULK_FILL = MAX_KEYS * 9 / 10;
+
+    // One spare entry: inserts overfill a node by one before splitting it
     struct Node {
         bool isLeaf;
         int numKeys;
-        Key keys[MAX_KEYS];
+        Key keys[MAX_KEYS+1];
         union {
             struct {
-                Value values[MAX_KEYS];
+                Value values[MAX_KEYS+1];
                 int next;
             } leaf;
-            int children[MAX_KEYS+1];
+            int children[MAX_KEYS+2];
         } ptr;
     };
 
-    static constexpr int HEADER_PAGE = 0;
-    static constexpr int MAX_KEYS = 128;
-    static_assert((int)sizeof(Node) <= FileManager::PAGE_SIZE,
+    static_assert((int)sizeof(Node) <= FileManager::USABLE_PAGE_SIZE,
                   "Node size exceeds page size");
 
     int fileId_;
@@ -53,7 +66,7 @@ private:
     void loadHeader();
     void writeHeader();
 
-    // Node serialization
+    // Node serialization, each under the page's latch
     void readNode(int pageId, Node &node) const;
     void writeNode(int pageId, const Node &node);
 
@@ -66,6 +79,9 @@ private:
 
     // Helper to find leaf page for a given key
     int findLeafPage(int pageId, const Key &key) const;
+
+    // Splits n items into the fewest groups of at most `cap`, evenly sized
+    static std::vector<int> groupSizes(int n, int cap);
 };
 
 // Implementation
@@ -74,12 +90,7 @@ template<typename Key, typename Value>
 BPlusTree<Key,Value>::BPlusTree(int fileId, BufferManager &bm)
     : fileId_(fileId), bm_(bm) {
     // On first use, if no pages, create header + empty leaf root
-    int pages = bm_.fetchPage(fileId_, 0), dummy = 0; bm_.unpinPage(fileId_,0);
-    pages = (int)bm_.fetchPage(fileId_,0); // just to call getPageCount
-    bm_.unpinPage(fileId_,0);
-    int count = bm_.fetchPage(fileId_,0)?0:0; (void)count;
-    int pageCount = bm_.bm_.fm_.getPageCount(fileId_);
-    if (pageCount == 0) {
+    if (bm_.fileManager().getPageCount(fileId_) == 0) {
         // Create header page
         allocatePage();
         // Create first leaf root
@@ -103,38 +114,31 @@ BPlusTree<Key,Value>::~BPlusTree() {
 
 template<typename Key, typename Value>
 void BPlusTree<Key,Value>::loadHeader() {
-    char *buf = bm_.fetchPage(fileId_, HEADER_PAGE);
-    std::memcpy(&rootPage_, buf, sizeof(rootPage_));
-    bm_.unpinPage(fileId_, HEADER_PAGE);
+    ReadPageGuard page(bm_, fileId_, HEADER_PAGE);
+    std::memcpy(&rootPage_, page.data(), sizeof(rootPage_));
 }
 
 template<typename Key, typename Value>
 void BPlusTree<Key,Value>::writeHeader() {
-    char *buf = bm_.fetchPage(fileId_, HEADER_PAGE);
-    std::memcpy(buf, &rootPage_, sizeof(rootPage_));
-    bm_.markDirty(fileId_, HEADER_PAGE);
-    bm_.unpinPage(fileId_, HEADER_PAGE);
+    WritePageGuard page(bm_, fileId_, HEADER_PAGE);
+    std::memcpy(page.data(), &rootPage_, sizeof(rootPage_));
 }
 
 template<typename Key, typename Value>
 void BPlusTree<Key,Value>::readNode(int pageId, Node &node) const {
-    char *buf = bm_.fetchPage(fileId_, pageId);
-    std::memcpy(&node, buf, sizeof(Node));
-    bm_.unpinPage(fileId_, pageId);
+    ReadPageGuard page(bm_, fileId_, pageId);
+    std::memcpy(&node, page.data(), sizeof(Node));
 }
 
 template<typename Key, typename Value>
 void BPlusTree<Key,Value>::writeNode(int pageId, const Node &node) {
-    char *buf = bm_.fetchPage(fileId_, pageId);
-    std::memcpy(buf, &node, sizeof(Node));
-    bm_.markDirty(fileId_, pageId);
-    bm_.unpinPage(fileId_, pageId);
+    WritePageGuard page(bm_, fileId_, pageId);
+    std::memcpy(page.data(), &node, sizeof(Node));
 }
 
 template<typename Key, typename Value>
 int BPlusTree<Key,Value>::allocatePage() {
-    int pid = bm_.bm_.fm_.allocatePage(fileId_);
-    return pid;
+    return bm_.fileManager().allocatePage(fileId_);
 }
 
 template<typename Key, typename Value>
@@ -232,7 +236,7 @@ auto BPlusTree<Key,Value>::insertRecursive(int pageId, const Key &key, const Val
             newInt.keys[i] = node.keys[split + 1 + i];
             newInt.ptr.children[i] = node.ptr.children[split + 1 + i];
         }
-        newInt.ptr.children[newInt.numKeys] = node.ptr.children[node.numKeys + 1];
+        newInt.ptr.children[newInt.numKeys] = node.ptr.children[node.numKeys];
         node.numKeys = split;
         writeNode(pageId, node);
         int newPage = allocatePage();
@@ -260,6 +264,81 @@ void BPlusTree<Key,Value>::insert(const Key &key, const Value &value) {
     }
 }
 
+template<typename Key, typename Value>
+std::vector<int> BPlusTree<Key,Value>::groupSizes(int n, int cap) {
+    int groups = (n + cap - 1) / cap;
+    std::vector<int> sizes(groups, n / groups);
+    for (int i = 0; i < n % groups; ++i) ++sizes[i];
+    return sizes;
+}
+
+template<typename Key, typename Value>
+void BPlusTree<Key,Value>::bulkLoad(std::vector<std::pair<Key, Value>> entries) {
+    if (entries.empty()) return;
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    // Keep the last value of each run of equal keys
+    std::vector<std::pair<Key, Value>> unique;
+    unique.reserve(entries.size());
+    for (auto &e : entries) {
+        if (!unique.empty() && unique.back().first == e.first) unique.back() = e;
+        else unique.push_back(e);
+    }
+
+    Node root;
+    readNode(rootPage_, root);
+    if (!root.isLeaf || root.numKeys > 0) {
+        for (auto &e : unique) insert(e.first, e.second);
+        return;
+    }
+
+    // Leaf level; the old empty root becomes the first leaf
+    std::vector<int> sizes = groupSizes(static_cast<int>(unique.size()), BULK_FILL);
+    std::vector<int> pages(sizes.size());
+    pages[0] = rootPage_;
+    for (std::size_t i = 1; i < pages.size(); ++i) pages[i] = allocatePage();
+    // Separator for each node: its smallest key
+    std::vector<Key> lowKeys;
+    std::size_t at = 0;
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        Node leaf{};
+        leaf.isLeaf = true;
+        leaf.numKeys = sizes[i];
+        for (int k = 0; k < sizes[i]; ++k, ++at) {
+            leaf.keys[k] = unique[at].first;
+            leaf.ptr.leaf.values[k] = unique[at].second;
+        }
+        leaf.ptr.leaf.next = i + 1 < pages.size() ? pages[i + 1] : -1;
+        writeNode(pages[i], leaf);
+        lowKeys.push_back(leaf.keys[0]);
+    }
+
+    // Internal levels until a single node is left
+    while (pages.size() > 1) {
+        sizes = groupSizes(static_cast<int>(pages.size()), BULK_FILL + 1);
+        std::vector<int> parents;
+        std::vector<Key> parentKeys;
+        std::size_t child = 0;
+        for (int count : sizes) {
+            Node node{};
+            node.isLeaf = false;
+            node.numKeys = count - 1;
+            for (int c = 0; c < count; ++c, ++child) {
+                node.ptr.children[c] = pages[child];
+                if (c > 0) node.keys[c - 1] = lowKeys[child];
+            }
+            int page = allocatePage();
+            writeNode(page, node);
+            parents.push_back(page);
+            parentKeys.push_back(lowKeys[child - count]);
+        }
+        pages.swap(parents);
+        lowKeys.swap(parentKeys);
+    }
+    rootPage_ = pages[0];
+    writeHeader();
+}
+
 // Delete from leaf only
 template<typename Key, typename Value>
 bool BPlusTree<Key,Value>::remove(const Key &key) {
@@ -286,6 +365,11 @@ std::vector<Value> BPlusTree<Key,Value>::rangeScan(const Key &low, const Key &hi
     Node node;
     readNode(leaf, node);
     while (true) {
+        // Load the next leaf while this one is filtered
+        if (node.ptr.leaf.next >= 0 && node.numKeys > 0 &&
+            node.keys[node.numKeys - 1] <= high) {
+            bm_.prefetchPage(fileId_, node.ptr.leaf.next);
+        }
         for (int i = 0; i < node.numKeys; ++i) {
             if (node.keys[i] >= low && node.keys[i] <= high) {
                 result.push_back(node.ptr.leaf.values[i]);
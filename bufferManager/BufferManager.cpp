@@ -3,110 +3,1044 @@
 #include "MetricsManager.h"
 #include <stdexcept>
 #include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <cstdint>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sys/mman.h>
 
-BufferManager::BufferManager(FileManager &fm, std::size_t poolSize)
-    : fm_(fm), poolSize_(poolSize), frames_(poolSize) {
-    // Allocate page buffers
-    for (auto &f : frames_) {
-        f.data = new char[FileManager::PAGE_SIZE];
+namespace {
+
+// Below this many frames per shard, replacement has too little to choose from
+constexpr std::size_t MIN_FRAMES_PER_SHARD = 16;
+
+std::size_t defaultShardCount(std::size_t poolSize) {
+    std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min(cores, poolSize / MIN_FRAMES_PER_SHARD));
+}
+
+std::size_t roundUp(std::size_t n, std::size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+// Reserves `bytes` of zeroed address space aligned to `align`; memory is
+// only committed as it is touched
+char *reserve(std::size_t bytes, std::size_t align) {
+    void *raw = mmap(nullptr, bytes + align, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    auto rawStart = reinterpret_cast<std::uintptr_t>(raw);
+    auto start = roundUp(rawStart, align);
+    if (start > rawStart) munmap(raw, start - rawStart);
+    std::size_t tail = rawStart + align - start;
+    if (tail > 0) munmap(reinterpret_cast<char *>(start + bytes), tail);
+    return reinterpret_cast<char *>(start);
+}
+
+// Counts a write-back from before its frames are pinned until they are
+// unpinned again
+class WriteBackScope {
+public:
+    explicit WriteBackScope(std::atomic<int> &count) : count_(count) {
+        count_.fetch_add(1, std::memory_order_acq_rel);
     }
+    ~WriteBackScope() { count_.fetch_sub(1, std::memory_order_acq_rel); }
+    WriteBackScope(const WriteBackScope &) = delete;
+    WriteBackScope &operator=(const WriteBackScope &) = delete;
+
+private:
+    std::atomic<int> &count_;
+};
+
+} // namespace
+
+BufferManager::BufferManager(FileManager &fm, std::size_t poolSize,
+                             std::size_t numShards, ReplacementPolicyKind policy,
+                             bool hugePages, std::size_t maxPoolSize)
+    : fm_(fm), poolSize_(poolSize),
+      maxPoolSize_(maxPoolSize ? maxPoolSize : poolSize * DEFAULT_MAX_POOL_FACTOR) {
+    if (poolSize == 0) throw std::runtime_error("Buffer pool size must be positive");
+    if (maxPoolSize_ < poolSize) throw std::runtime_error("Buffer pool larger than its maximum");
+    if (numShards == 0) numShards = defaultShardCount(poolSize);
+    if (numShards > poolSize) throw std::runtime_error("More shards than buffer frames");
+
+    // One arena for all frames, so every frame can be handed straight to
+    // O_DIRECT reads and writes. It is aligned to a huge page boundary so
+    // the kernel can back all of it with 2 MiB pages: a random lookup then
+    // costs one TLB entry per 256 frames instead of one per frame.
+    arenaBytes_ = roundUp(maxPoolSize_ * FileManager::PAGE_SIZE, HUGE_PAGE_SIZE);
+    arena_ = reserve(arenaBytes_, HUGE_PAGE_SIZE);
+    framesBytes_ = roundUp(maxPoolSize_ * sizeof(Frame), FileManager::PAGE_SIZE);
+    try {
+        frames_ = reinterpret_cast<Frame *>(reserve(framesBytes_, FileManager::PAGE_SIZE));
+    } catch (...) {
+        munmap(arena_, arenaBytes_);
+        throw;
+    }
+#ifdef MADV_HUGEPAGE
+    hugePages_ = hugePages && madvise(arena_, arenaBytes_, MADV_HUGEPAGE) == 0;
+    // Under THP "always" the kernel would use huge pages anyway
+    if (!hugePages) madvise(arena_, arenaBytes_, MADV_NOHUGEPAGE);
+#else
+    (void)hugePages;
+#endif
+    buildFrames(poolSize);
+
+    // Deal frames out round-robin; the first (poolSize % numShards) shards
+    // get one extra
+    for (std::size_t s = 0; s < numShards; ++s) {
+        auto shard = std::make_unique<Shard>();
+        shard->policy = ReplacementPolicy::create(policy, 0);
+        shards_.push_back(std::move(shard));
+    }
+    // Popped from the back: hand out low frame ids first
+    for (std::size_t i = poolSize; i-- > 0;) {
+        Shard &shard = *shards_[i % numShards];
+        shard.freeFrames.push_back(i);
+        ++shard.frameCount;
+    }
+    for (auto &s : shards_) resizeShardState(*s);
 }
 
 BufferManager::~BufferManager() {
+    warmStop_ = true;
+    waitForWarmUp();
+    stopResidentSetSaver();
+    stopBackgroundWriter();
+    stopPrefetchWorker();
     flushAllPages();
-    for (auto &f : frames_) {
-        delete[] f.data;
+    for (std::size_t i = 0; i < framesBuilt_; ++i) frames_[i].~Frame();
+    munmap(frames_, framesBytes_);
+    munmap(arena_, arenaBytes_);
+}
+
+void BufferManager::buildFrames(std::size_t count) {
+    for (std::size_t i = framesBuilt_; i < count; ++i) {
+        Frame *f = new (&frames_[i]) Frame();
+        f->data = arena_ + i * FileManager::PAGE_SIZE;
+    }
+    // Published last: flushes only look at constructed frames
+    if (count > framesBuilt_) framesBuilt_.store(count, std::memory_order_release);
+}
+
+void BufferManager::resizeShardState(Shard &shard) {
+    shard.policy->setCapacity(shard.frameCount);
+    // Each shard gets its share of the bulk rings, but never more than a
+    // quarter of its frames
+    auto ringSize = [&](std::size_t total) {
+        return std::max<std::size_t>(1, std::min(total / shards_.size(), shard.frameCount / 4));
+    };
+    for (AccessStrategy strategy : {AccessStrategy::BULK_READ, AccessStrategy::BULK_WRITE}) {
+        Ring &ring = shard.rings[static_cast<int>(strategy)];
+        ring.capacity = ringSize(strategy == AccessStrategy::BULK_READ
+                                     ? BULK_READ_RING_PAGES : BULK_WRITE_RING_PAGES);
+        if (ring.slots.size() > ring.capacity) {
+            // Dropped slots' frames stay resident and go back to the policy
+            ring.slots.resize(ring.capacity);
+            ring.next = 0;
+        }
+    }
+}
+
+void BufferManager::setPoolSize(std::size_t frames) {
+    std::lock_guard<std::mutex> resize(resizeMutex_);
+    if (frames > maxPoolSize_)
+        throw std::runtime_error("Buffer pool size exceeds the reserved maximum of " +
+                                 std::to_string(maxPoolSize_) + " pages");
+    if (frames < shards_.size())
+        throw std::runtime_error("Buffer pool needs at least one frame per shard");
+    std::size_t old = poolSize_.load();
+    std::size_t n = shards_.size();
+
+    if (frames > old) {
+        buildFrames(frames);
+        for (std::size_t s = 0; s < n; ++s) {
+            Shard &shard = *shards_[s];
+            std::unique_lock<std::shared_mutex> guard(shard.latch);
+            std::size_t first = old + (s + n - old % n) % n;
+            for (std::size_t i = first; i < frames; i += n) {
+                shard.freeFrames.insert(shard.freeFrames.begin(), i);
+                ++shard.frameCount;
+            }
+            resizeShardState(shard);
+        }
+        poolSize_ = frames;
+        return;
+    }
+
+    // Shrink from the top, one frame at a time, so an error leaves the
+    // pool consistent at whatever size was reached
+    std::size_t size = old;
+    try {
+        for (; size > frames; --size) retireFrame(size - 1);
+    } catch (...) {
+        poolSize_ = size;
+        if (size < old) {
+            madvise(arena_ + size * FileManager::PAGE_SIZE,
+                    (old - size) * FileManager::PAGE_SIZE, MADV_DONTNEED);
+        }
+        throw;
+    }
+    poolSize_ = frames;
+    // Hand the retired frames' memory back; a later grow faults in zeroes
+    madvise(arena_ + frames * FileManager::PAGE_SIZE,
+            (old - frames) * FileManager::PAGE_SIZE, MADV_DONTNEED);
+}
+
+void BufferManager::retireFrame(std::size_t frameIdx) {
+    Shard &shard = *shards_[frameIdx % shards_.size()];
+    Frame &f = frames_[frameIdx];
+    auto deadline = std::chrono::steady_clock::now() + RETIRE_TIMEOUT;
+    for (;;) {
+        {
+            std::unique_lock<std::shared_mutex> guard(shard.latch);
+            auto free = std::find(shard.freeFrames.begin(), shard.freeFrames.end(), frameIdx);
+            bool retired = false;
+            if (free != shard.freeFrames.end()) {
+                shard.freeFrames.erase(free);
+                retired = true;
+            } else if (f.isValid && f.pinCount.load(std::memory_order_acquire) == 0) {
+                shard.policy->remove(frameIdx);
+                evictFrame(shard, frameIdx);
+                retired = true;
+            }
+            if (retired) {
+                --shard.frameCount;
+                resizeShardState(shard);
+                return;
+            }
+        }
+        // Pinned (or being prefetched): wait for its holder to let go, but
+        // not forever, since resizeMutex_ is held meanwhile
+        if (std::chrono::steady_clock::now() >= deadline)
+            throw std::runtime_error("Buffer frame " + std::to_string(frameIdx) +
+                                     " stayed pinned; pool shrink stopped");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+BufferManager::Shard &BufferManager::shardFor(const PageId &pid) {
+    // Mix the bits: consecutive pages of a file should land on different shards
+    std::size_t h = PageIdHash()(pid) * 0x9E3779B97F4A7C15ull;
+    return *shards_[(h >> 32) % shards_.size()];
+}
+
+std::size_t BufferManager::residentFrame(Shard &shard, const PageId &pid) {
+    auto it = shard.pageTable.find(pid);
+    if (it == shard.pageTable.end()) throw std::runtime_error("Page not in buffer pool");
+    return it->second;
+}
+
+char *BufferManager::pinResident(Shard &shard, std::size_t frameIdx) {
+    Frame &f = frames_[frameIdx];
+    f.pinCount.fetch_add(1, std::memory_order_acq_rel);
+    if (shard.policy->concurrentAccess()) {
+        shard.policy->recordAccess(frameIdx);
+    } else {
+        std::lock_guard<std::mutex> guard(shard.policyLatch);
+        shard.policy->recordAccess(frameIdx);
     }
+    return f.data;
 }
 
-char *BufferManager::fetchPage(int fileId, int pageId) {
+std::uint64_t BufferManager::hitCount() const {
+    std::uint64_t n = 0;
+    for (auto &s : shards_) n += s->hits.load(std::memory_order_relaxed);
+    return n;
+}
+
+std::uint64_t BufferManager::missCount() const {
+    std::uint64_t n = 0;
+    for (auto &s : shards_) n += s->misses.load(std::memory_order_relaxed);
+    return n;
+}
+
+char *BufferManager::fetchPage(int fileId, int pageId, AccessStrategy strategy) {
     PageId pid{fileId, pageId};
-    auto it = pageTable_.find(pid);
-    if (it != pageTable_.end()) {
-        // Already in pool
+    Shard &shard = shardFor(pid);
+    // A bulk pass touching a page must not make it look hot
+    bool bulk = strategy != AccessStrategy::NORMAL;
+    auto hit = [&](std::size_t frameIdx) -> Frame & {
         MetricsManager::instance().incBufferHit();
-        Frame &f = frames_[it->second];
-        f.pinCount++;
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        Frame &f = frames_[frameIdx];
+        if (bulk) {
+            f.pinCount.fetch_add(1, std::memory_order_acq_rel);
+            return f;
+        }
+        // A normal reference claims the page back from any ring
+        if (f.bulkOnly.load(std::memory_order_relaxed)) f.bulkOnly.store(false);
+        pinResident(shard, frameIdx);
+        return f;
+    };
+    // A hit on a page still being prefetched waits for the read, outside
+    // the shard latch
+    auto ready = [&](Frame &f) {
+        if (f.loadState.load(std::memory_order_acquire) != LOADED) awaitLoad(f);
         return f.data;
+    };
+    Frame *resident = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> guard(shard.latch);
+        auto it = shard.pageTable.find(pid);
+        if (it != shard.pageTable.end()) {
+            // Already in pool
+            resident = &hit(it->second);
+        }
     }
+    if (resident) return ready(*resident);
 
-    // Need to load into pool
-    std::size_t frameIdx = selectVictimFrame();
-    Frame &victim = frames_[frameIdx];
+    // A miss publishes the frame LOADING and reads with the shard latch
+    // dropped, so hits and other misses in the shard are not held up by
+    // the I/O; fetchers of the same page wait on the frame instead
+    std::unique_lock<std::shared_mutex> guard(shard.latch, std::defer_lock);
+    bool cleanOnly = true;
+    std::size_t frameIdx;
+    for (;;) {
+        guard.lock();
+        auto it = shard.pageTable.find(pid);
+        if (it != shard.pageTable.end()) {
+            // Loaded by another thread while we waited for the latch
+            resident = &hit(it->second);
+            guard.unlock();
+            return ready(*resident);
+        }
+        if (bulk) {
+            // A ring recycles its own dirty frames: write the next one back
+            // first so it can be reused in place
+            WriteBackScope writeBack(writeBacks_);
+            Frame *victim = pinDirtyRingFrame(shard.rings[static_cast<int>(strategy)]);
+            if (victim) {
+                victim->missWritten.store(true, std::memory_order_relaxed);
+                guard.unlock();
+                writePinned({victim});
+                continue;
+            }
+        }
+        frameIdx = claimFrame(shard, pid, strategy, cleanOnly);
+        if (frameIdx != NO_FRAME) break;
+        guard.unlock();
+        // Every victim is dirty: write a few back without the latch. If
+        // none could be pinned, wait out the write-backs in progress; with
+        // none left, all frames are in use and the next claim says so.
+        std::vector<Frame *> pinned;
+        {
+            WriteBackScope writeBack(writeBacks_);
+            if (pinUpcomingDirty(shard, MISS_WRITE_BATCH, MISS_WRITE_BATCH, pinned) > 0) {
+                for (Frame *f : pinned) f->missWritten.store(true, std::memory_order_relaxed);
+                kickBackgroundWriter();
+                writePinned(pinned);
+                continue;
+            }
+        }
+        if (writeBacks_.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        } else {
+            cleanOnly = false;
+        }
+    }
+    MetricsManager::instance().incBufferMiss();
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    guard.unlock();
+
+    // The claim's pin is the caller's. On failure the frame stays mapped
+    // as FAILED, and the next fetch retries the read.
+    Frame &frame = frames_[frameIdx];
+    try {
+        if (!takeCached(pid, frame.data)) fm_.readPage(fileId, pageId, frame.data);
+    } catch (...) {
+        publishLoad(frame, -EIO);
+        unpinFrame(frame);
+        throw;
+    }
+    publishLoad(frame, 0);
+    return frame.data;
+}
+
+std::size_t BufferManager::acquireRingFrame(Shard &shard, Ring &ring, Ring::Slot **slot,
+                                            bool cleanOnly) {
+    if (ring.slots.size() < ring.capacity) {
+        // Ring still filling up: take frames the normal way
+        std::size_t idx = acquireFrame(shard, cleanOnly);
+        if (idx == NO_FRAME) return NO_FRAME;
+        ring.slots.reserve(ring.capacity);
+        ring.slots.push_back({idx, {-1, -1}});
+        *slot = &ring.slots.back();
+        return idx;
+    }
+    Ring::Slot &s = ring.slots[ring.next];
+    ring.next = (ring.next + 1) % ring.slots.size();
+    *slot = &s;
+    Frame &f = frames_[s.frame];
+    if (f.isValid && f.pid == s.pid && f.bulkOnly.load(std::memory_order_relaxed) &&
+        f.pinCount.load(std::memory_order_acquire) == 0 &&
+        !(cleanOnly && f.isDirty.load(std::memory_order_acquire))) {
+        // Still ours and not in use: recycle it in place
+        shard.policy->remove(s.frame);
+        evictFrame(shard, s.frame);
+        return s.frame;
+    }
+    // The frame was evicted and reused, claimed by a normal reference, or
+    // is pinned: leave it to the policy and replace the slot
+    std::size_t idx = acquireFrame(shard, cleanOnly);
+    if (idx != NO_FRAME) s.frame = idx;
+    return idx;
+}
+
+BufferManager::Frame *BufferManager::pinDirtyRingFrame(Ring &ring) {
+    if (ring.slots.size() < ring.capacity) return nullptr;
+    const Ring::Slot &s = ring.slots[ring.next];
+    Frame &f = frames_[s.frame];
+    if (!f.isValid || !(f.pid == s.pid) || !f.bulkOnly.load(std::memory_order_relaxed) ||
+        f.pinCount.load(std::memory_order_acquire) != 0 ||
+        !f.isDirty.load(std::memory_order_acquire)) return nullptr;
+    f.pinCount.fetch_add(1, std::memory_order_acq_rel);
+    return &f;
+}
 
-    // If valid and dirty, write back
-    if (victim.isValid) {
-        if (victim.isDirty) {
+std::size_t BufferManager::acquireFrame(Shard &shard, bool cleanOnly) {
+    if (!shard.freeFrames.empty()) {
+        std::size_t idx = shard.freeFrames.back();
+        shard.freeFrames.pop_back();
+        return idx;
+    }
+    std::size_t idx;
+    bool found = shard.policy->evict(
+        [this, cleanOnly](std::size_t i) {
+            return frames_[i].pinCount.load(std::memory_order_acquire) == 0 &&
+                   !(cleanOnly && frames_[i].isDirty.load(std::memory_order_acquire));
+        },
+        idx);
+    if (!found) {
+        if (cleanOnly) return NO_FRAME;
+        throw std::runtime_error("All buffer frames are pinned; no victim available");
+    }
+    evictFrame(shard, idx);
+    return idx;
+}
+
+void BufferManager::evictFrame(Shard &shard, std::size_t frameIdx) {
+    // If dirty, write back
+    Frame &victim = frames_[frameIdx];
+    bool dirty = takeDirty(victim);
+    bool written = dirty || victim.missWritten.exchange(false, std::memory_order_relaxed);
+    if (dirty) {
+        try {
             fm_.writePage(victim.pid.fileId, victim.pid.pageId, victim.data);
-            victim.isDirty = false;
+        } catch (...) {
+            // Keep the page resident and tracked
+            setDirty(victim);
+            shard.policy->recordLoad(frameIdx, pageKey(victim.pid));
+            throw;
         }
-        // Remove old mapping
-        pageTable_.erase(victim.pid);
+        kickBackgroundWriter();
     }
+    (written ? dirtyEvictions_ : cleanEvictions_).fetch_add(1, std::memory_order_relaxed);
+    MetricsManager::instance().incBufferEviction(written);
+    // The page now matches the disk: keep a compressed copy. Scan pages
+    // and failed loads are not worth one, but must not leave an old copy.
+    if (cache_.enabled()) {
+        if (!victim.bulkOnly.load(std::memory_order_relaxed) &&
+            victim.loadState.load(std::memory_order_acquire) == LOADED) {
+            cache_.put(victim.pid.fileId, victim.pid.pageId, victim.data);
+        } else {
+            cache_.erase(victim.pid.fileId, victim.pid.pageId);
+        }
+    }
+    // Remove old mapping
+    shard.pageTable.erase(victim.pid);
+    victim.isValid = false;
+}
+
+void BufferManager::kickBackgroundWriter() {
+    // The background writer fell behind: wake it now
+    if (!bgRunning_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lk(bgMutex_);
+    bgKick_ = true;
+    bgCv_.notify_one();
+}
 
-    // Read new page
-    fm_.readPage(fileId, pageId, victim.data);
-    victim.isValid = true;
-    victim.isDirty = false;
-    victim.pinCount = 1;
-    victim.pid = pid;
-    pageTable_[pid] = frameIdx;
-    return victim.data;
+bool BufferManager::takeCached(const PageId &pid, char *data) {
+    if (!cache_.enabled()) return false;
+    bool hit = cache_.take(pid.fileId, pid.pageId, data);
+    MetricsManager::instance().incCompressedCacheLookup(hit);
+    return hit;
 }
 
 void BufferManager::pinPage(int fileId, int pageId) {
     PageId pid{fileId, pageId};
-    auto it = pageTable_.find(pid);
-    if (it == pageTable_.end()) throw std::runtime_error("Page not in buffer pool");
-    frames_[it->second].pinCount++;
+    Shard &shard = shardFor(pid);
+    std::shared_lock<std::shared_mutex> guard(shard.latch);
+    pinResident(shard, residentFrame(shard, pid));
 }
 
 void BufferManager::unpinPage(int fileId, int pageId) {
     PageId pid{fileId, pageId};
-    auto it = pageTable_.find(pid);
-    if (it == pageTable_.end()) throw std::runtime_error("Page not in buffer pool");
-    Frame &f = frames_[it->second];
-    if (f.pinCount <= 0) throw std::runtime_error("Unpin on page with pinCount=0");
-    f.pinCount--;
+    Shard &shard = shardFor(pid);
+    std::shared_lock<std::shared_mutex> guard(shard.latch);
+    unpinFrame(frames_[residentFrame(shard, pid)]);
+}
+
+void BufferManager::unpinFrame(Frame &f) {
+    int pins = f.pinCount.load(std::memory_order_acquire);
+    do {
+        if (pins <= 0) throw std::runtime_error("Unpin on page with pinCount=0");
+    } while (!f.pinCount.compare_exchange_weak(pins, pins - 1, std::memory_order_acq_rel));
 }
 
 void BufferManager::markDirty(int fileId, int pageId) {
     PageId pid{fileId, pageId};
-    auto it = pageTable_.find(pid);
-    if (it == pageTable_.end()) throw std::runtime_error("Page not in buffer pool");
-    frames_[it->second].isDirty = true;
+    Shard &shard = shardFor(pid);
+    std::shared_lock<std::shared_mutex> guard(shard.latch);
+    setDirty(frames_[residentFrame(shard, pid)]);
 }
 
 void BufferManager::flushPage(int fileId, int pageId) {
     PageId pid{fileId, pageId};
-    auto it = pageTable_.find(pid);
-    if (it == pageTable_.end()) return; // nothing to flush
-    Frame &f = frames_[it->second];
-    if (f.isValid && f.isDirty) {
-        fm_.writePage(fileId, pageId, f.data);
-        f.isDirty = false;
+    Shard &shard = shardFor(pid);
+    Frame *f;
+    {
+        std::shared_lock<std::shared_mutex> guard(shard.latch);
+        auto it = shard.pageTable.find(pid);
+        if (it == shard.pageTable.end()) return; // nothing to flush
+        f = &frames_[it->second];
+        if (!f->isValid || !f->isDirty.load(std::memory_order_acquire)) return;
+        // Pinned, the frame stays put once the shard latch is dropped
+        f->pinCount.fetch_add(1, std::memory_order_acq_rel);
+    }
+    try {
+        writeLatched(*f);
+    } catch (...) {
+        unpinFrame(*f);
+        throw;
+    }
+    unpinFrame(*f);
+}
+
+void BufferManager::discardPage(int fileId, int pageId) {
+    PageId pid{fileId, pageId};
+    Shard &shard = shardFor(pid);
+    {
+        std::unique_lock<std::shared_mutex> guard(shard.latch);
+        auto it = shard.pageTable.find(pid);
+        if (it != shard.pageTable.end()) {
+            std::size_t frameIdx = it->second;
+            Frame &f = frames_[frameIdx];
+            // An in-flight load holds a pin too
+            if (f.pinCount.load(std::memory_order_acquire) != 0) {
+                throw std::runtime_error("Cannot discard pinned page " + std::to_string(pageId));
+            }
+            takeDirty(f);
+            shard.policy->remove(frameIdx);
+            shard.pageTable.erase(it);
+            f.isValid = false;
+            shard.freeFrames.push_back(frameIdx);
+        }
     }
+    cache_.erase(fileId, pageId);
+}
+
+bool BufferManager::writeLatched(Frame &f) {
+    std::shared_lock<std::shared_mutex> page(f.latch);
+    // Clear the dirty bit before writing, so a markDirty racing with the
+    // write is not lost
+    if (!takeDirty(f)) return false;
+    try {
+        fm_.writePage(f.pid.fileId, f.pid.pageId, f.data);
+    } catch (...) {
+        setDirty(f);
+        throw;
+    }
+    return true;
+}
+
+template <typename Pick>
+void BufferManager::flushFrames(Pick pick) {
+    // Pin the dirty frames under the shard latches, then drop those before
+    // touching any page latch: a writer holding a page latch may be waiting
+    // for a shard latch to load another page
+    WriteBackScope writeBack(writeBacks_);
+    std::vector<Frame *> pinned;
+    {
+        std::vector<std::shared_lock<std::shared_mutex>> guards;
+        for (auto &s : shards_) guards.emplace_back(s->latch);
+        std::size_t built = framesBuilt_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < built; ++i) {
+            Frame &f = frames_[i];
+            if (f.isValid && pick(f) && f.isDirty.load(std::memory_order_acquire)) {
+                f.pinCount.fetch_add(1, std::memory_order_acq_rel);
+                pinned.push_back(&f);
+            }
+        }
+    }
+    writePinned(pinned);
+}
+
+std::size_t BufferManager::writePinned(const std::vector<Frame *> &pinned) {
+    if (pinned.empty()) return 0;
+    // Pages nobody is modifying go out in one coalesced write. Pages that
+    // are write-latched right now are written afterwards one at a time,
+    // waiting on each latch while holding no other.
+    std::vector<Frame *> latched, contended;
+    std::size_t written = 0;
+    try {
+        std::vector<PageWrite> writes;
+        std::vector<Frame *> flushed;
+        for (Frame *f : pinned) {
+            if (!f->latch.try_lock_shared()) {
+                contended.push_back(f);
+                continue;
+            }
+            latched.push_back(f);
+            if (takeDirty(*f)) {
+                writes.push_back({f->pid.fileId, f->pid.pageId, f->data});
+                flushed.push_back(f);
+            }
+        }
+        if (!writes.empty()) {
+            try {
+                fm_.writePages(std::move(writes));
+            } catch (...) {
+                for (Frame *f : flushed) setDirty(*f);
+                throw;
+            }
+            written = flushed.size();
+        }
+        for (Frame *f : latched) f->latch.unlock_shared();
+        latched.clear();
+        for (Frame *f : contended) written += writeLatched(*f);
+    } catch (...) {
+        for (Frame *f : latched) f->latch.unlock_shared();
+        for (Frame *f : pinned) unpinFrame(*f);
+        throw;
+    }
+    for (Frame *f : pinned) unpinFrame(*f);
+    return written;
+}
+
+void BufferManager::flushFile(int fileId) {
+    flushFrames([fileId](const Frame &f) { return f.pid.fileId == fileId; });
 }
 
 void BufferManager::flushAllPages() {
-    for (auto &f : frames_) {
-        if (f.isValid && f.isDirty) {
-            fm_.writePage(f.pid.fileId, f.pid.pageId, f.data);
-            f.isDirty = false;
+    // One coalesced bulk write for every dirty frame, then a sync barrier
+    flushFrames([](const Frame &) { return true; });
+    fm_.syncAll();
+}
+
+void BufferManager::startBackgroundWriter(const BackgroundWriterConfig &config) {
+    stopBackgroundWriter();
+    bgConfig_ = config;
+    bgStop_ = false;
+    bgKick_ = false;
+    bgRunning_ = true;
+    bgWriter_ = std::thread([this] { backgroundWriterLoop(); });
+}
+
+void BufferManager::stopBackgroundWriter() {
+    if (!bgWriter_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(bgMutex_);
+        bgStop_ = true;
+    }
+    bgCv_.notify_one();
+    bgWriter_.join();
+    bgRunning_ = false;
+}
+
+void BufferManager::backgroundWriterLoop() {
+    // Flush rate is published once per window of at least a second
+    auto windowStart = std::chrono::steady_clock::now();
+    std::uint64_t windowPages = 0;
+    std::vector<Frame *> pinned;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(bgMutex_);
+            bgCv_.wait_for(lk, bgConfig_.interval, [this] { return bgStop_ || bgKick_; });
+            if (bgStop_) {
+                // Count the partial window; the writer no longer flushes
+                if (windowPages > 0)
+                    MetricsManager::instance().recordBgWriterFlushes(windowPages, 0);
+                return;
+            }
+            bgKick_ = false;
+        }
+        // The default target follows the pool as it is resized
+        std::size_t target = bgConfig_.cleanTarget ? bgConfig_.cleanTarget
+                                                   : std::max<std::size_t>(1, poolSize() / 8);
+        std::size_t perShard = std::max<std::size_t>(1, target / shards_.size());
+        WriteBackScope writeBack(writeBacks_);
+        pinned.clear();
+        std::size_t budget = bgConfig_.maxPagesPerRound;
+        for (auto &s : shards_) {
+            if (budget == 0) break;
+            budget -= pinUpcomingDirty(*s, perShard, budget, pinned);
+        }
+        // Candidates cleaned since they were picked are not counted
+        std::size_t written = 0;
+        try {
+            written = writePinned(pinned);
+        } catch (const std::exception &) {
+            // Pages stay dirty; eviction or the next flush reports the error
         }
+        bgWrites_.fetch_add(written, std::memory_order_relaxed);
+        windowPages += written;
+
+        auto now = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(now - windowStart).count();
+        if (secs >= 1.0) {
+            MetricsManager::instance().recordBgWriterFlushes(
+                windowPages, static_cast<std::uint64_t>(windowPages / secs));
+            windowStart = now;
+            windowPages = 0;
+        }
+    }
+}
+
+std::size_t BufferManager::pinUpcomingDirty(Shard &shard, std::size_t target,
+                                            std::size_t budget,
+                                            std::vector<Frame *> &pinned) {
+    std::shared_lock<std::shared_mutex> guard(shard.latch);
+    std::size_t clean = shard.freeFrames.size();
+    if (clean >= target) return 0;
+    std::vector<std::size_t> victims;
+    {
+        std::lock_guard<std::mutex> policyGuard(shard.policyLatch);
+        shard.policy->upcomingVictims(
+            [this](std::size_t i) {
+                return frames_[i].pinCount.load(std::memory_order_acquire) == 0;
+            },
+            target - clean, victims);
     }
+    std::size_t count = 0;
+    for (std::size_t idx : victims) {
+        if (count == budget) break;
+        Frame &f = frames_[idx];
+        if (!f.isDirty.load(std::memory_order_acquire)) continue;
+        // Pinned so it stays put until written; evict() skips it meanwhile
+        f.pinCount.fetch_add(1, std::memory_order_acq_rel);
+        pinned.push_back(&f);
+        ++count;
+    }
+    return count;
+}
+
+std::size_t BufferManager::reserveLoad(const PageId &pid, AccessStrategy strategy,
+                                       bool freeOnly) {
+    Shard &shard = shardFor(pid);
+    {
+        std::shared_lock<std::shared_mutex> guard(shard.latch);
+        if (shard.pageTable.count(pid)) return NO_FRAME;
+    }
+    std::unique_lock<std::shared_mutex> guard(shard.latch);
+    if (shard.pageTable.count(pid)) return NO_FRAME;
+    if (freeOnly && shard.freeFrames.empty()) return NO_FRAME;
+    // Only clean frames: a background read must never wait on a write-back
+    return claimFrame(shard, pid, strategy, true);
+}
+
+std::size_t BufferManager::claimFrame(Shard &shard, const PageId &pid,
+                                      AccessStrategy strategy, bool cleanOnly) {
+    bool bulk = strategy != AccessStrategy::NORMAL;
+    Ring::Slot *slot = nullptr;
+    std::size_t frameIdx = bulk
+        ? acquireRingFrame(shard, shard.rings[static_cast<int>(strategy)], &slot, cleanOnly)
+        : acquireFrame(shard, cleanOnly);
+    if (frameIdx == NO_FRAME) return NO_FRAME;
+    Frame &frame = frames_[frameIdx];
+    frame.isValid = true;
+    frame.isDirty = false;
+    // The read's pin keeps the frame in place until it completes
+    frame.pinCount.store(1, std::memory_order_release);
+    frame.bulkOnly.store(bulk, std::memory_order_relaxed);
+    frame.missWritten.store(false, std::memory_order_relaxed);
+    frame.loadState.store(LOADING, std::memory_order_release);
+    frame.pid = pid;
+    shard.pageTable[pid] = frameIdx;
+    shard.policy->recordLoad(frameIdx, pageKey(pid));
+    if (slot) slot->pid = pid;
+    return frameIdx;
 }
 
-std::size_t BufferManager::selectVictimFrame() {
-    for (std::size_t i = 0; i < poolSize_; ++i) {
-        clockHand_ = (clockHand_ + 1) % poolSize_;
-        Frame &f = frames_[clockHand_];
-        if (!f.isValid) {
-            return clockHand_;
+bool BufferManager::prefetchPage(int fileId, int pageId, AccessStrategy strategy) {
+    std::size_t frameIdx = reserveLoad({fileId, pageId}, strategy, false);
+    if (frameIdx == NO_FRAME) return false;
+    prefetches_.fetch_add(1, std::memory_order_relaxed);
+    if (takeCached({fileId, pageId}, frames_[frameIdx].data)) {
+        // Already in memory: nothing to read
+        finishLoad(frames_[frameIdx], 0);
+        return true;
+    }
+
+    PageRequest req;
+    req.fileId = fileId;
+    req.pageId = pageId;
+    req.buffer = frames_[frameIdx].data;
+    req.onComplete = [this, frameIdx](int result) { finishLoad(frames_[frameIdx], result); };
+    {
+        std::lock_guard<std::mutex> lk(pfMutex_);
+        if (!pfWorker_.joinable()) {
+            pfStop_ = false;
+            pfWorker_ = std::thread([this] { prefetchWorkerLoop(); });
         }
-        if (f.pinCount == 0) {
-            return clockHand_;
+        pfQueue_.push_back(std::move(req));
+    }
+    pfCv_.notify_one();
+    return true;
+}
+
+std::size_t BufferManager::prefetchRange(int fileId, int first, int count,
+                                         AccessStrategy strategy) {
+    std::size_t issued = 0;
+    for (int p = first; p < first + count; ++p) {
+        if (prefetchPage(fileId, p, strategy)) ++issued;
+    }
+    return issued;
+}
+
+void BufferManager::publishLoad(Frame &f, int result) {
+    {
+        std::lock_guard<std::mutex> lk(ioMutex_);
+        f.loadState.store(result == 0 ? LOADED : FAILED, std::memory_order_release);
+    }
+    ioCv_.notify_all();
+}
+
+void BufferManager::finishLoad(Frame &f, int result) {
+    publishLoad(f, result);
+    unpinFrame(f);
+}
+
+void BufferManager::awaitLoad(Frame &f) {
+    {
+        std::unique_lock<std::mutex> lk(ioMutex_);
+        ioCv_.wait(lk, [&f] {
+            return f.loadState.load(std::memory_order_acquire) != LOADING;
+        });
+    }
+    if (f.loadState.load(std::memory_order_acquire) == LOADED) return;
+    // The background read failed: redo it here so the caller gets the
+    // real error (or the page, if the failure was transient)
+    std::lock_guard<std::shared_mutex> page(f.latch);
+    if (f.loadState.load(std::memory_order_acquire) != FAILED) return;
+    try {
+        fm_.readPage(f.pid.fileId, f.pid.pageId, f.data);
+    } catch (...) {
+        unpinFrame(f);
+        throw;
+    }
+    f.loadState.store(LOADED, std::memory_order_release);
+}
+
+void BufferManager::prefetchWorkerLoop() {
+    AsyncPageIO io(fm_, PREFETCH_QUEUE_DEPTH);
+    std::vector<PageRequest> batch;
+    std::vector<PageCompletion> done;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(pfMutex_);
+            if (io.inFlight() == 0) {
+                pfCv_.wait(lk, [this] { return pfStop_ || !pfQueue_.empty(); });
+            }
+            if (pfStop_ && pfQueue_.empty() && io.inFlight() == 0) return;
+            batch.swap(pfQueue_);
+        }
+        if (!batch.empty()) {
+            std::vector<Frame *> submitted;
+            for (auto &r : batch) submitted.push_back(&frameOf(r.buffer));
+            try {
+                io.submit(std::move(batch));
+            } catch (const std::exception &) {
+                // Let whatever made it in finish, then fail the rest so
+                // their waiters fall back to a synchronous read
+                std::vector<PageCompletion> ignored;
+                try { io.drain(ignored); } catch (...) {}
+                for (Frame *f : submitted) {
+                    if (f->loadState.load(std::memory_order_acquire) == LOADING) {
+                        finishLoad(*f, -EIO);
+                    }
+                }
+            }
+            batch.clear();
+        }
+        // Wait for at least one read, then look for new requests again
+        done.clear();
+        io.poll(done, true);
+    }
+}
+
+void BufferManager::saveResidentSet(const std::string &path) const {
+    // Each shard's frames hottest first: the reverse of eviction order
+    std::vector<std::vector<PageId>> perShard;
+    for (auto &s : shards_) {
+        std::shared_lock<std::shared_mutex> guard(s->latch);
+        std::vector<std::size_t> order;
+        {
+            std::lock_guard<std::mutex> policyGuard(s->policyLatch);
+            s->policy->upcomingVictims([](std::size_t) { return true; },
+                                       s->pageTable.size(), order);
+        }
+        std::vector<PageId> pages;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const Frame &f = frames_[*it];
+            if (!f.isValid || f.bulkOnly.load(std::memory_order_relaxed) ||
+                f.loadState.load(std::memory_order_acquire) != LOADED) continue;
+            pages.push_back(f.pid);
+        }
+        perShard.push_back(std::move(pages));
+    }
+
+    // Interleave the shards so the file is hottest first pool-wide
+    std::string tmp = path + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot write resident set: " + tmp);
+    std::unordered_map<int, std::string> paths;
+    for (std::size_t rank = 0;; ++rank) {
+        bool any = false;
+        for (auto &pages : perShard) {
+            if (rank >= pages.size()) continue;
+            any = true;
+            const PageId &pid = pages[rank];
+            auto known = paths.find(pid.fileId);
+            if (known == paths.end()) {
+                std::string name;
+                try {
+                    name = fm_.filePath(pid.fileId);
+                } catch (const std::exception &) {
+                    // Closed since the page was loaded
+                }
+                known = paths.emplace(pid.fileId, name).first;
+            }
+            if (!known->second.empty()) out << pid.pageId << '\t' << known->second << '\n';
+        }
+        if (!any) break;
+    }
+    out.close();
+    if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Cannot write resident set: " + path);
+    }
+}
+
+void BufferManager::startResidentSetSaver(const std::string &path,
+                                          std::chrono::seconds interval) {
+    stopResidentSetSaver();
+    {
+        std::lock_guard<std::mutex> lk(saverMutex_);
+        saverStop_ = false;
+        saverPath_ = path;
+    }
+    saver_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lk(saverMutex_);
+        for (;;) {
+            bool stopping = saverCv_.wait_for(lk, interval, [this] { return saverStop_; });
+            try {
+                saveResidentSet(saverPath_);
+            } catch (const std::exception &) {
+                // Best effort: a stale or missing file only costs warm-up
+            }
+            if (stopping) return;
+        }
+    });
+}
+
+void BufferManager::stopResidentSetSaver() {
+    if (!saver_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(saverMutex_);
+        saverStop_ = true;
+    }
+    saverCv_.notify_one();
+    // The saver writes the set one last time before exiting
+    saver_.join();
+}
+
+std::size_t BufferManager::startWarmUp(const std::string &path) {
+    waitForWarmUp();
+    std::ifstream in(path);
+    if (!in) return 0;
+
+    std::vector<PageId> pages;
+    std::unordered_map<std::string, int> fileIds;
+    std::size_t limit = poolSize();
+    std::string line;
+    while (pages.size() < limit && std::getline(in, line)) {
+        auto tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        std::string name = line.substr(tab + 1);
+        auto known = fileIds.find(name);
+        if (known == fileIds.end()) known = fileIds.emplace(name, fm_.findFile(name)).first;
+        if (known->second < 0) continue;
+        int pageId = std::atoi(line.c_str());
+        if (pageId < 0 || pageId >= fm_.getPageCount(known->second)) continue;
+        pages.push_back({known->second, pageId});
+    }
+    // Hotness only decided what fits; load in disk order
+    std::sort(pages.begin(), pages.end(), [](const PageId &a, const PageId &b) {
+        return a.fileId != b.fileId ? a.fileId < b.fileId : a.pageId < b.pageId;
+    });
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+    std::size_t queued = pages.size();
+    if (queued == 0) return 0;
+    warmStop_ = false;
+    warmThread_ = std::thread([this, pages = std::move(pages)]() mutable {
+        warmUpLoop(std::move(pages));
+    });
+    return queued;
+}
+
+void BufferManager::waitForWarmUp() {
+    if (warmThread_.joinable()) warmThread_.join();
+}
+
+void BufferManager::warmUpLoop(std::vector<PageId> pages) {
+    std::vector<Frame *> run;
+    std::vector<char *> buffers;
+    PageId first{-1, -1};
+    auto readRun = [&] {
+        if (run.empty()) return;
+        int result = 0;
+        try {
+            fm_.readPages(first.fileId, first.pageId, buffers.data(),
+                          static_cast<int>(buffers.size()));
+            warmed_.fetch_add(run.size(), std::memory_order_relaxed);
+        } catch (const std::exception &) {
+            // Fetches of these pages redo the read and see the error
+            result = -EIO;
         }
+        for (Frame *f : run) finishLoad(*f, result);
+        run.clear();
+        buffers.clear();
+    };
+    for (const PageId &pid : pages) {
+        if (warmStop_.load(std::memory_order_relaxed)) break;
+        bool adjacent = !run.empty() && pid.fileId == first.fileId &&
+                        pid.pageId == first.pageId + static_cast<int>(run.size()) &&
+                        run.size() < static_cast<std::size_t>(WARMUP_RUN_PAGES);
+        if (!adjacent) readRun();
+        std::size_t frameIdx = reserveLoad(pid, AccessStrategy::NORMAL, true);
+        if (frameIdx == NO_FRAME) {
+            // Resident already, or its shard is full: the run breaks here
+            readRun();
+            continue;
+        }
+        if (run.empty()) first = pid;
+        run.push_back(&frames_[frameIdx]);
+        buffers.push_back(frames_[frameIdx].data);
     }
-    throw std::runtime_error("All buffer frames are pinned; no victim available");
-}
\ No newline at end of file
+    readRun();
+}
+
+void BufferManager::stopPrefetchWorker() {
+    {
+        std::lock_guard<std::mutex> lk(pfMutex_);
+        if (!pfWorker_.joinable()) return;
+        pfStop_ = true;
+    }
+    pfCv_.notify_one();
+    // The worker finishes every queued and in-flight read before exiting
+    pfWorker_.join();
+}
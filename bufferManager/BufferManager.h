@@ -1,33 +1,187 @@
 // File: BufferManager.h
 #pragma once
 
+#include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <cstddef>
+#include <cstdint>
 #include "FileManager.h"
+#include "AsyncPageIO.h"
+#include "CompressedPageCache.h"
 #include "MetricsManager.h"
+#include "ReplacementPolicy.h"
 
+// How a fetch should use the pool. NORMAL pages compete for frames under
+// the replacement policy. Bulk operations (full scans, ANALYZE, bulk loads)
+// instead recycle a small per-shard ring of frames, so one pass over a big
+// table cannot push the hot working set out of the pool: a bulk miss reuses
+// the ring's oldest frame, and bulk hits do not count as references.
+enum class AccessStrategy {
+    NORMAL,
+    BULK_READ,   // ring of BULK_READ_RING_PAGES frames across the pool
+    BULK_WRITE   // larger ring; recycled dirty frames are written back
+};
 
+class ReadPageGuard;
+class WritePageGuard;
+
+// Settings for BufferManager::startBackgroundWriter
+struct BackgroundWriterConfig {
+    // Pause between rounds, unless a miss has to write dirty victims
+    std::chrono::milliseconds interval{100};
+    // Clean, evictable frames to keep ready across the pool (0 = poolSize/8)
+    std::size_t cleanTarget = 0;
+    // Upper bound on pages written per round
+    std::size_t maxPagesPerRound = 256;
+};
+
+// Thread-safe buffer pool. Frames are split into shards by a hash of the
+// page id; each shard has its own latch, page table and replacement policy,
+// so threads touching different pages rarely contend. Hits and unpins take
+// a shard's latch in shared mode and adjust atomic pin counts; a miss takes
+// it exclusively only to map the page to a frame in LOADING state, and does
+// its I/O (reading the page, writing back dirty victims) without it.
+//
+// Page contents are protected separately by a latch per frame, taken
+// through ReadPageGuard/WritePageGuard (PageGuard.h). fetchPage/unpinPage
+// only pin; callers that share pages between threads should use guards.
 class BufferManager {
 public:
-    // Create a buffer pool of given size (number of pages)
-    explicit BufferManager(FileManager &fm, std::size_t poolSize = 128);
+    // Create a buffer pool of given size (number of pages) split into
+    // numShards partitions (0 = pick from the pool size), each evicting
+    // with the given replacement policy. Frames live in one arena backed by
+    // transparent huge pages where the kernel allows; hugePages = false
+    // forces 4 KiB pages (for comparison runs). Address space for
+    // maxPoolSize frames (0 = DEFAULT_MAX_POOL_FACTOR * poolSize) is
+    // reserved up front so setPoolSize never moves a frame; only frames in
+    // use take memory.
+    explicit BufferManager(FileManager &fm, std::size_t poolSize = 128,
+                           std::size_t numShards = 0,
+                           ReplacementPolicyKind policy = ReplacementPolicyKind::CLOCK,
+                           bool hugePages = true, std::size_t maxPoolSize = 0);
     ~BufferManager();
+    BufferManager(const BufferManager &) = delete;
+    BufferManager &operator=(const BufferManager &) = delete;
+
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 << 20;
+    // Default growth headroom; kept small because the reservation is
+    // still charged against the commit limit when overcommit is disabled
+    static constexpr std::size_t DEFAULT_MAX_POOL_FACTOR = 4;
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    // Pool-wide ring sizes for the bulk strategies, in pages
+    static constexpr std::size_t BULK_READ_RING_PAGES = 32;
+    static constexpr std::size_t BULK_WRITE_RING_PAGES = 128;
+
+    // Fetches the specified page into the buffer pool (pin++). Returns pointer
+    // to page data; the page latch is not taken.
+    char *fetchPage(int fileId, int pageId,
+                    AccessStrategy strategy = AccessStrategy::NORMAL);
+    // Starts reading the page into a free (or clean, unpinned) frame in the
+    // background and returns without pinning it. A fetchPage that arrives
+    // while the read is in flight waits for it. Never blocks on I/O; returns
+    // false if the page is already resident or no frame is free.
+    bool prefetchPage(int fileId, int pageId,
+                      AccessStrategy strategy = AccessStrategy::NORMAL);
+    // Prefetches pages [first, first + count); returns how many were issued
+    std::size_t prefetchRange(int fileId, int first, int count,
+                              AccessStrategy strategy = AccessStrategy::NORMAL);
 
-    // Fetches the specified page into the buffer pool (pin++). Returns pointer to page data.
-    char *fetchPage(int fileId, int pageId);
     // Pin/unpin allow managing multiple users of the same page
     void pinPage(int fileId, int pageId);
     void unpinPage(int fileId, int pageId);
     // Mark the page as dirty so it will be written back on eviction or flush
     void markDirty(int fileId, int pageId);
 
-    // Explicitly write a dirty page back to disk
+    // Explicitly write a dirty page back to disk. Flushes take each page's
+    // latch shared while writing it, so never call them while holding a
+    // WritePageGuard.
     void flushPage(int fileId, int pageId);
-    // Flush all dirty pages
+    // Write back every dirty page of one file (no sync)
+    void flushFile(int fileId);
+    // Flush all dirty pages with one coalesced bulk write and make them
+    // durable (checkpoint / shutdown path)
     void flushAllPages();
+    // Drops the page from the pool and the compressed tier without writing
+    // it back. Call it before FileManager::deallocatePage, which rewrites
+    // the page on disk behind the pool's back. Throws if the page is pinned.
+    void discardPage(int fileId, int pageId);
+
+    // Starts a thread that writes back dirty frames the replacement policy
+    // is about to evict, keeping cleanTarget clean victims ready so misses
+    // only pay for their read. Calling it again restarts with the new config.
+    void startBackgroundWriter(const BackgroundWriterConfig &config = {});
+    void stopBackgroundWriter();
+
+    // Warm-up across restarts. The resident set is a text file listing
+    // resident pages hottest first (by the replacement policy's order, bulk
+    // ring pages left out), one "pageId<TAB>path" per line.
+    void saveResidentSet(const std::string &path) const;
+    // Saves the resident set to path every interval and once more when the
+    // pool shuts down. Calling it again restarts with the new settings.
+    void startResidentSetSaver(const std::string &path,
+                               std::chrono::seconds interval = std::chrono::seconds(60));
+    void stopResidentSetSaver();
+    // Reloads a saved resident set in the background: the hottest pages
+    // that fit are sorted and read in runs of adjacent pages, one preadv per
+    // run, into free frames only (warm-up never evicts). Entries for files
+    // that are not open, or pages past their end, are skipped. Fetches of a
+    // page still being loaded wait for it. Returns the number of entries
+    // queued; a missing file queues nothing.
+    std::size_t startWarmUp(const std::string &path);
+    // Blocks until warm-up has finished (e.g. before accepting traffic)
+    void waitForWarmUp();
+    // Pages loaded by warm-up since construction
+    std::uint64_t warmedPages() const { return warmed_.load(std::memory_order_relaxed); }
+
+    // Second tier for evicted pages, kept compressed in memory (see
+    // CompressedPageCache); misses check it before going to disk. Off
+    // (0 bytes) by default; can be resized or turned off at any time.
+    void setCompressedCacheBytes(std::size_t bytes) { cache_.setCapacity(bytes); }
+    const CompressedPageCache &compressedCache() const { return cache_; }
+
+    // Grows or shrinks the pool while it is in use. New frames start out
+    // free; shrinking evicts (writing back) the frames it removes and waits
+    // up to RETIRE_TIMEOUT for each one that is pinned to be released, then
+    // returns their memory to the OS. Throws beyond maxPoolSize(), below one
+    // frame per shard, or if a frame stays pinned; a failed shrink leaves
+    // the pool at the size it had reached.
+    void setPoolSize(std::size_t frames);
+    static constexpr std::chrono::seconds RETIRE_TIMEOUT{5};
+
+    std::size_t poolSize() const { return poolSize_.load(std::memory_order_relaxed); }
+    std::size_t maxPoolSize() const { return maxPoolSize_; }
+    std::size_t numShards() const { return shards_.size(); }
+    const char *policyName() const { return shards_.front()->policy->name(); }
+    // True if the kernel accepted the huge page hint for the frame arena
+    bool hugePages() const { return hugePages_; }
+    // Fetches served from the pool / loaded from disk since construction
+    std::uint64_t hitCount() const;
+    std::uint64_t missCount() const;
+    // Frames holding changes not yet written back
+    std::size_t dirtyCount() const { return dirtyFrames_.load(std::memory_order_relaxed); }
+    // Victims evicted as-is / that had to be written first
+    std::uint64_t cleanEvictions() const { return cleanEvictions_.load(std::memory_order_relaxed); }
+    std::uint64_t dirtyEvictions() const { return dirtyEvictions_.load(std::memory_order_relaxed); }
+    // Pages written by the background writer
+    std::uint64_t backgroundWrites() const { return bgWrites_.load(std::memory_order_relaxed); }
+    // Prefetch reads issued
+    std::uint64_t prefetchCount() const { return prefetches_.load(std::memory_order_relaxed); }
+
+    FileManager &fileManager() const { return fm_; }
 
 private:
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
+
     // Identifier for a page in a file
     struct PageId {
         int fileId;
@@ -45,20 +199,214 @@ private:
         }
     };
 
-    struct Frame {
+    // Prefetched frames are mapped before their data arrives
+    enum LoadState : std::uint8_t {
+        LOADED,
+        LOADING,  // read in flight; the read holds a pin
+        FAILED    // read failed; the next fetch retries synchronously
+    };
+
+    // isValid and pid change only under the owning shard's exclusive latch;
+    // pinCount and isDirty may change under its shared latch. `latch`
+    // guards the bytes at `data` and is only taken while pinned. Each frame
+    // gets its own cache line(s), apart from the page data, so pin traffic
+    // on one frame does not bounce its neighbours.
+    struct alignas(CACHE_LINE_SIZE) Frame {
+        std::shared_mutex latch;
         bool isValid = false;
-        bool isDirty = false;
-        int pinCount = 0;
+        std::atomic<bool> isDirty{false};
+        std::atomic<int> pinCount{0};
+        // Loaded by a bulk strategy and not referenced normally since;
+        // only such frames are recycled by a ring
+        std::atomic<bool> bulkOnly{false};
+        // Written back by a miss that wanted it as a victim: its eviction
+        // counts as a dirty one
+        std::atomic<bool> missWritten{false};
+        std::atomic<std::uint8_t> loadState{LOADED};
         PageId pid = {-1, -1};
         char *data = nullptr;
     };
 
+    // Frames recently loaded by one bulk strategy, reused round-robin. A
+    // slot remembers which page it loaded so a frame the policy has since
+    // handed to someone else is not stolen back.
+    struct Ring {
+        struct Slot {
+            std::size_t frame;
+            PageId pid;
+        };
+        std::vector<Slot> slots;
+        std::size_t capacity = 0;
+        std::size_t next = 0;
+    };
+
+    // A slice of frames_ with its own page table and replacement state.
+    // Frame i belongs to shard i % numShards, so resizing from the top of
+    // the arena grows or shrinks every shard evenly.
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        mutable std::shared_mutex latch;
+        std::unordered_map<PageId, std::size_t, PageIdHash> pageTable;
+        // Frames holding no page; the policy only tracks resident ones
+        std::vector<std::size_t> freeFrames;
+        std::unique_ptr<ReplacementPolicy> policy;
+        // Serializes recordAccess on the hit path for policies that need it
+        std::mutex policyLatch;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        // Indexed by AccessStrategy; the NORMAL entry is unused
+        Ring rings[3];
+        // Frames currently owned (free or resident)
+        std::size_t frameCount = 0;
+    };
+
     FileManager &fm_;
-    std::size_t poolSize_;
-    std::vector<Frame> frames_;
-    std::unordered_map<PageId, std::size_t, PageIdHash> pageTable_;
-    std::size_t clockHand_ = 0;
-
-    // Find a frame to evict using CLOCK algorithm
-    std::size_t selectVictimFrame();
-};
\ No newline at end of file
+    // Frames [0, poolSize_) are in service
+    std::atomic<std::size_t> poolSize_;
+    std::size_t maxPoolSize_;
+    // Contiguous storage backing every frame's data: an anonymous mapping
+    // aligned to HUGE_PAGE_SIZE, arenaBytes_ long, reserved for
+    // maxPoolSize_ frames
+    char *arena_ = nullptr;
+    std::size_t arenaBytes_ = 0;
+    bool hugePages_ = false;
+    // Frame metadata, reserved the same way; entries [0, framesBuilt_)
+    // are constructed (those past poolSize_ are retired and invalid)
+    Frame *frames_ = nullptr;
+    std::size_t framesBytes_ = 0;
+    std::atomic<std::size_t> framesBuilt_{0};
+    // Serializes setPoolSize calls
+    std::mutex resizeMutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    CompressedPageCache cache_;
+
+    std::atomic<std::size_t> dirtyFrames_{0};
+    std::atomic<std::uint64_t> cleanEvictions_{0};
+    std::atomic<std::uint64_t> dirtyEvictions_{0};
+    std::atomic<std::uint64_t> bgWrites_{0};
+
+    // Background writer; bgKick_ asks for a round before the interval ends
+    std::thread bgWriter_;
+    std::mutex bgMutex_;
+    std::condition_variable bgCv_;
+    bool bgStop_ = false;
+    bool bgKick_ = false;
+    std::atomic<bool> bgRunning_{false};
+    BackgroundWriterConfig bgConfig_;
+    // Dirty victims a miss writes back itself when no clean one is left
+    static constexpr std::size_t MISS_WRITE_BATCH = 8;
+    // Write-backs in progress (pinning or writing frames). Their pins are
+    // transient, so a miss finding every frame pinned waits for them
+    // rather than give up.
+    std::atomic<int> writeBacks_{0};
+
+    // Prefetch worker: owns an AsyncPageIO and submits pfQueue_; started
+    // by the first prefetch. ioMutex_/ioCv_ signal finished loads.
+    static constexpr unsigned PREFETCH_QUEUE_DEPTH = 64;
+    std::thread pfWorker_;
+    std::mutex pfMutex_;
+    std::condition_variable pfCv_;
+    std::vector<PageRequest> pfQueue_;
+    bool pfStop_ = false;
+    std::mutex ioMutex_;
+    std::condition_variable ioCv_;
+    std::atomic<std::uint64_t> prefetches_{0};
+
+    // Warm-up loader and periodic resident-set saver
+    static constexpr int WARMUP_RUN_PAGES = 64;
+    std::thread warmThread_;
+    std::atomic<bool> warmStop_{false};
+    std::atomic<std::uint64_t> warmed_{0};
+    std::thread saver_;
+    std::mutex saverMutex_;
+    std::condition_variable saverCv_;
+    bool saverStop_ = false;
+    std::string saverPath_;
+
+    Shard &shardFor(const PageId &pid);
+    // Frame index holding pid; caller holds the shard latch. Throws if not resident.
+    std::size_t residentFrame(Shard &shard, const PageId &pid);
+    // Pins a resident frame and tells the policy; caller holds the shard latch
+    char *pinResident(Shard &shard, std::size_t frameIdx);
+    // Frame owning a pointer returned by fetchPage
+    Frame &frameOf(const char *data) {
+        return frames_[static_cast<std::size_t>(data - arena_) / FileManager::PAGE_SIZE];
+    }
+    // pin--; the pin itself keeps the frame in place, so no shard latch
+    void unpinFrame(Frame &f);
+    // Writes one pinned frame under its shared page latch; false if it
+    // was clean by then
+    bool writeLatched(Frame &f);
+    // Writes back and unpins frames pinned by the caller, coalescing those
+    // whose latch is free; caller holds no latches. Returns how many were
+    // still dirty and written.
+    std::size_t writePinned(const std::vector<Frame *> &pinned);
+    // All dirty-bit changes go through these to keep dirtyFrames_ exact
+    void setDirty(Frame &f) {
+        if (!f.isDirty.exchange(true, std::memory_order_acq_rel))
+            dirtyFrames_.fetch_add(1, std::memory_order_relaxed);
+    }
+    bool takeDirty(Frame &f) {
+        if (!f.isDirty.exchange(false, std::memory_order_acq_rel)) return false;
+        dirtyFrames_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    void backgroundWriterLoop();
+    // Wakes the background writer early, when a miss found dirty victims
+    void kickBackgroundWriter();
+    // Fills data from the compressed tier if it holds the page
+    bool takeCached(const PageId &pid, char *data);
+    // Claims a frame for pid and marks it LOADING with the read's pin held;
+    // the caller issues the read and calls finishLoad. Returns NO_FRAME if
+    // pid is resident or no suitable frame is free (freeOnly: no eviction
+    // at all; otherwise only clean victims).
+    std::size_t reserveLoad(const PageId &pid, AccessStrategy strategy, bool freeOnly);
+    // Maps pid to a new frame in LOADING state, pinned once for the read;
+    // caller holds the shard latch exclusively and has checked pid is not
+    // resident. NO_FRAME as for acquireFrame.
+    std::size_t claimFrame(Shard &shard, const PageId &pid, AccessStrategy strategy,
+                           bool cleanOnly);
+    // Loads pages (sorted by file and page) in runs of adjacent pages
+    void warmUpLoop(std::vector<PageId> pages);
+    // Resize helpers; caller holds resizeMutex_
+    void buildFrames(std::size_t count);
+    void retireFrame(std::size_t frameIdx);
+    // Re-derives policy capacity and ring sizes from frameCount; caller
+    // holds the shard latch exclusively
+    void resizeShardState(Shard &shard);
+    // Pins dirty frames among the shard's next victims until `target`
+    // victims would be clean; returns how many it pinned (at most budget)
+    std::size_t pinUpcomingDirty(Shard &shard, std::size_t target, std::size_t budget,
+                                 std::vector<Frame *> &pinned);
+    // Returns a free frame, evicting (and writing back) the policy's victim
+    // if there is none; caller holds the shard latch exclusively. With
+    // cleanOnly, dirty victims are skipped and NO_FRAME may be returned.
+    static constexpr std::size_t NO_FRAME = static_cast<std::size_t>(-1);
+    std::size_t acquireFrame(Shard &shard, bool cleanOnly = false);
+    // Like acquireFrame, but recycles the strategy's ring; *slot is set to
+    // the ring slot to stamp once the new page is loaded
+    std::size_t acquireRingFrame(Shard &shard, Ring &ring, Ring::Slot **slot,
+                                 bool cleanOnly = false);
+    // Pins and returns the frame the ring recycles next if it is still the
+    // ring's and dirty, so it can be written back without the shard latch;
+    // caller holds the shard latch exclusively
+    Frame *pinDirtyRingFrame(Ring &ring);
+    // Waits out a prefetch of a frame the caller has pinned; retries the
+    // read if it failed (unpinning and rethrowing if that fails too)
+    void awaitLoad(Frame &f);
+    // Ends a LOADING state and wakes the waiters; finishLoad also drops
+    // the read's pin
+    void publishLoad(Frame &f, int result);
+    void finishLoad(Frame &f, int result);
+    void prefetchWorkerLoop();
+    void stopPrefetchWorker();
+    // Drops a resident, unpinned frame's page (writing it back if dirty)
+    void evictFrame(Shard &shard, std::size_t frameIdx);
+    static std::uint64_t pageKey(const PageId &pid) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(pid.fileId)) << 32) |
+               static_cast<std::uint32_t>(pid.pageId);
+    }
+    // Writes back the dirty frames selected by `pick`
+    template <typename Pick>
+    void flushFrames(Pick pick);
+};
@@ -0,0 +1,123 @@
+// File: CompressedPageCache.cpp
+#include "CompressedPageCache.h"
+#include "FileManager.h"
+#include "LZCodec.h"
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+// Compressed pages larger than this are not worth the memory
+constexpr std::size_t MAX_STORED_BYTES = FileManager::PAGE_SIZE / 2;
+
+// Per-thread compression output; sized for the worst case
+char *scratch() {
+    thread_local std::vector<char> buf(LZCodec::maxCompressedSize(FileManager::PAGE_SIZE));
+    return buf.data();
+}
+
+} // namespace
+
+CompressedPageCache::CompressedPageCache(std::size_t capacityBytes)
+    : capacity_(capacityBytes) {}
+
+CompressedPageCache::Partition &CompressedPageCache::partitionFor(std::uint64_t key) {
+    return partitions_[std::hash<std::uint64_t>()(key) % NUM_PARTITIONS];
+}
+
+void CompressedPageCache::dropLocked(Partition &p, std::uint64_t key) {
+    auto it = p.index.find(key);
+    if (it == p.index.end()) return;
+    p.bytes -= it->second->blob.size();
+    p.lru.erase(it->second);
+    p.index.erase(it);
+}
+
+void CompressedPageCache::trimLocked(Partition &p, std::size_t limit) {
+    while (p.bytes > limit && !p.lru.empty()) {
+        p.bytes -= p.lru.back().blob.size();
+        p.index.erase(p.lru.back().key);
+        p.lru.pop_back();
+    }
+}
+
+void CompressedPageCache::put(int fileId, int pageId, const char *page) {
+    std::uint64_t key = keyOf(fileId, pageId);
+    Partition &p = partitionFor(key);
+    std::size_t limit = partitionLimit();
+    // Compress outside the latch; a rejected page still drops the old copy
+    std::size_t size = 0;
+    if (limit > 0) {
+        size = LZCodec::compress(page, FileManager::PAGE_SIZE, scratch(),
+                                 LZCodec::maxCompressedSize(FileManager::PAGE_SIZE));
+        if (size > MAX_STORED_BYTES || size > limit) size = 0;
+    }
+    std::lock_guard<std::mutex> guard(p.latch);
+    dropLocked(p, key);
+    if (size == 0) return;
+    trimLocked(p, limit - size);
+    const char *data = scratch();
+    p.lru.push_front({key, std::vector<char>(data, data + size)});
+    p.index[key] = p.lru.begin();
+    p.bytes += size;
+}
+
+void CompressedPageCache::erase(int fileId, int pageId) {
+    std::uint64_t key = keyOf(fileId, pageId);
+    Partition &p = partitionFor(key);
+    std::lock_guard<std::mutex> guard(p.latch);
+    dropLocked(p, key);
+}
+
+bool CompressedPageCache::take(int fileId, int pageId, char *page) {
+    std::uint64_t key = keyOf(fileId, pageId);
+    Partition &p = partitionFor(key);
+    std::vector<char> blob;
+    {
+        std::lock_guard<std::mutex> guard(p.latch);
+        auto it = p.index.find(key);
+        if (it == p.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        blob.swap(it->second->blob);
+        p.bytes -= blob.size();
+        p.lru.erase(it->second);
+        p.index.erase(it);
+    }
+    try {
+        LZCodec::decompress(blob.data(), blob.size(), page, FileManager::PAGE_SIZE);
+    } catch (const std::exception &) {
+        // Corrupt entry: already dropped, let the caller read the disk
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CompressedPageCache::setCapacity(std::size_t bytes) {
+    capacity_.store(bytes, std::memory_order_relaxed);
+    for (auto &p : partitions_) {
+        std::lock_guard<std::mutex> guard(p.latch);
+        trimLocked(p, bytes / NUM_PARTITIONS);
+    }
+}
+
+std::size_t CompressedPageCache::bytesUsed() const {
+    std::size_t total = 0;
+    for (auto &p : partitions_) {
+        std::lock_guard<std::mutex> guard(p.latch);
+        total += p.bytes;
+    }
+    return total;
+}
+
+std::size_t CompressedPageCache::pageCount() const {
+    std::size_t total = 0;
+    for (auto &p : partitions_) {
+        std::lock_guard<std::mutex> guard(p.latch);
+        total += p.lru.size();
+    }
+    return total;
+}
@@ -0,0 +1,83 @@
+// File: CompressedPageCache.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Second-tier cache for pages evicted from the buffer pool, kept LZ
+// compressed in memory (LZCodec). A buffer miss that finds its page here
+// is served by decompression instead of a disk read; the entry then moves
+// back into the pool, so a page lives in at most one of the two tiers.
+//
+// The cache only ever holds copies that match the disk: the pool offers a
+// page on every eviction (after writing it back if dirty) and any older
+// copy of that page is replaced or dropped. The only writes that bypass
+// the pool are FileManager's free-chain updates (deallocatePage writes the
+// link, allocatePage zeroes a reused page); BufferManager::discardPage
+// must drop the page from both tiers before it is deallocated.
+//
+// Capacity is in compressed bytes and is split evenly across partitions,
+// each with its own latch and LRU list; the least recently stored page is
+// dropped first. Pages that compress to more than half a page are not kept.
+// A capacity of 0 disables the cache.
+class CompressedPageCache {
+public:
+    explicit CompressedPageCache(std::size_t capacityBytes = 0);
+    CompressedPageCache(const CompressedPageCache &) = delete;
+    CompressedPageCache &operator=(const CompressedPageCache &) = delete;
+
+    // Offers a page (PAGE_SIZE bytes) that matches its on-disk copy
+    void put(int fileId, int pageId, const char *page);
+    // Forgets any copy of the page
+    void erase(int fileId, int pageId);
+    // Decompresses the page into `page` and removes it from the cache.
+    // Returns false (a miss) if it is not cached or its entry is corrupt.
+    bool take(int fileId, int pageId, char *page);
+
+    // Shrinking drops least recently stored pages until the new limit holds
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+    bool enabled() const { return capacity() > 0; }
+
+    std::uint64_t hitCount() const { return hits_.load(std::memory_order_relaxed); }
+    std::uint64_t missCount() const { return misses_.load(std::memory_order_relaxed); }
+    // Compressed bytes and pages currently held
+    std::size_t bytesUsed() const;
+    std::size_t pageCount() const;
+
+private:
+    static constexpr std::size_t NUM_PARTITIONS = 16;
+
+    struct Entry {
+        std::uint64_t key;
+        std::vector<char> blob;
+    };
+    struct Partition {
+        mutable std::mutex latch;
+        // Most recently stored at the front
+        std::list<Entry> lru;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+        std::size_t bytes = 0;
+    };
+
+    static std::uint64_t keyOf(int fileId, int pageId) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(fileId)) << 32) |
+               static_cast<std::uint32_t>(pageId);
+    }
+    Partition &partitionFor(std::uint64_t key);
+    // Removes key; caller holds p.latch
+    static void dropLocked(Partition &p, std::uint64_t key);
+    // Drops LRU entries until p fits in limit; caller holds p.latch
+    static void trimLocked(Partition &p, std::size_t limit);
+    std::size_t partitionLimit() const { return capacity() / NUM_PARTITIONS; }
+
+    std::atomic<std::size_t> capacity_;
+    Partition partitions_[NUM_PARTITIONS];
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
@@ -0,0 +1,69 @@
+// File: PageGuard.cpp
+#include "PageGuard.h"
+#include <utility>
+
+ReadPageGuard::ReadPageGuard(BufferManager &bm, int fileId, int pageId,
+                             AccessStrategy strategy)
+    : bm_(&bm), fileId_(fileId), pageId_(pageId) {
+    data_ = bm.fetchPage(fileId, pageId, strategy);
+    // The pin keeps the frame from being reassigned while we wait
+    bm.frameOf(data_).latch.lock_shared();
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&other) noexcept
+    : bm_(other.bm_), fileId_(other.fileId_), pageId_(other.pageId_),
+      data_(std::exchange(other.data_, nullptr)) {}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other) noexcept {
+    if (this != &other) {
+        release();
+        bm_ = other.bm_;
+        fileId_ = other.fileId_;
+        pageId_ = other.pageId_;
+        data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+}
+
+void ReadPageGuard::release() {
+    if (!data_) return;
+    BufferManager::Frame &f = bm_->frameOf(data_);
+    f.latch.unlock_shared();
+    bm_->unpinFrame(f);
+    data_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(BufferManager &bm, int fileId, int pageId,
+                               AccessStrategy strategy)
+    : bm_(&bm), fileId_(fileId), pageId_(pageId) {
+    data_ = bm.fetchPage(fileId, pageId, strategy);
+    BufferManager::Frame &f = bm.frameOf(data_);
+    f.latch.lock();
+    // Dirty from the start: flushers only clear the bit under the page
+    // latch, so it stays set until after we unlatch, and a flush that
+    // starts meanwhile waits for our changes instead of skipping the page
+    bm.setDirty(f);
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&other) noexcept
+    : bm_(other.bm_), fileId_(other.fileId_), pageId_(other.pageId_),
+      data_(std::exchange(other.data_, nullptr)) {}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other) noexcept {
+    if (this != &other) {
+        release();
+        bm_ = other.bm_;
+        fileId_ = other.fileId_;
+        pageId_ = other.pageId_;
+        data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+}
+
+void WritePageGuard::release() {
+    if (!data_) return;
+    BufferManager::Frame &f = bm_->frameOf(data_);
+    f.latch.unlock();
+    bm_->unpinFrame(f);
+    data_ = nullptr;
+}
@@ -0,0 +1,66 @@
+// File: PageGuard.h
+#pragma once
+
+#include "BufferManager.h"
+
+// RAII handles on a buffer pool page. A guard pins the page and holds its
+// frame latch for as long as it lives: shared for ReadPageGuard, exclusive
+// for WritePageGuard. A write guard marks the page dirty as soon as it is
+// latched. Destruction (or release()) drops the latch and then the pin. Guards are move-only;
+// a moved-from or released guard is empty and owns nothing.
+//
+// Latch order: never wait for a page latch while holding a guard on a page
+// that another thread could be waiting for in the opposite order. Heap code
+// and B+ tree operations hold one page at a time; the tree does no latch
+// coupling, so its structure is only consistent across a descent because
+// callers serialize writers with the table lock (readers take it shared).
+class ReadPageGuard {
+public:
+    ReadPageGuard() = default;
+    ReadPageGuard(BufferManager &bm, int fileId, int pageId,
+                  AccessStrategy strategy = AccessStrategy::NORMAL);
+    ~ReadPageGuard() { release(); }
+    ReadPageGuard(ReadPageGuard &&other) noexcept;
+    ReadPageGuard &operator=(ReadPageGuard &&other) noexcept;
+    ReadPageGuard(const ReadPageGuard &) = delete;
+    ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+    const char *data() const { return data_; }
+    int fileId() const { return fileId_; }
+    int pageId() const { return pageId_; }
+    explicit operator bool() const { return data_ != nullptr; }
+    // Unlatch and unpin now; the guard becomes empty
+    void release();
+
+private:
+    BufferManager *bm_ = nullptr;
+    int fileId_ = -1;
+    int pageId_ = -1;
+    char *data_ = nullptr;
+};
+
+class WritePageGuard {
+public:
+    WritePageGuard() = default;
+    WritePageGuard(BufferManager &bm, int fileId, int pageId,
+                   AccessStrategy strategy = AccessStrategy::NORMAL);
+    ~WritePageGuard() { release(); }
+    WritePageGuard(WritePageGuard &&other) noexcept;
+    WritePageGuard &operator=(WritePageGuard &&other) noexcept;
+    WritePageGuard(const WritePageGuard &) = delete;
+    WritePageGuard &operator=(const WritePageGuard &) = delete;
+
+    char *data() { return data_; }
+    const char *data() const { return data_; }
+    int fileId() const { return fileId_; }
+    int pageId() const { return pageId_; }
+    explicit operator bool() const { return data_ != nullptr; }
+    // Unlatch and unpin now; the guard becomes empty
+    void release();
+
+private:
+    BufferManager *bm_ = nullptr;
+    int fileId_ = -1;
+    int pageId_ = -1;
+    char *data_ = nullptr;
+};
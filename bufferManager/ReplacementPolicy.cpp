@@ -0,0 +1,333 @@
+// File: ReplacementPolicy.cpp
+#include "ReplacementPolicy.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------- CLOCK ---
+
+class ClockPolicy : public ReplacementPolicy {
+public:
+    const char *name() const override { return "CLOCK"; }
+    // Reference bits are atomics and the slot map only changes under the
+    // exclusive latch, so hits need no extra locking
+    bool concurrentAccess() const override { return true; }
+
+    void setCapacity(std::size_t) override {}
+
+    void recordLoad(std::size_t frameId, std::uint64_t) override {
+        std::size_t slot;
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            slot = ring_.size();
+            ring_.emplace_back();  // deque: existing slots never move
+        }
+        ring_[slot].frame = frameId;
+        ring_[slot].referenced.store(true, std::memory_order_relaxed);
+        slotOf_[frameId] = slot;
+    }
+
+    void recordAccess(std::size_t frameId) override {
+        auto it = slotOf_.find(frameId);
+        if (it != slotOf_.end()) {
+            ring_[it->second].referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void remove(std::size_t frameId) override {
+        auto it = slotOf_.find(frameId);
+        if (it == slotOf_.end()) return;
+        ring_[it->second].frame = NONE;
+        freeSlots_.push_back(it->second);
+        slotOf_.erase(it);
+    }
+
+    bool evict(const std::function<bool(std::size_t)> &evictable,
+               std::size_t &frameId) override {
+        if (ring_.empty()) return false;
+        // Two full sweeps: the first may only clear reference bits
+        for (std::size_t i = 0; i < 2 * ring_.size() + 1; ++i) {
+            hand_ = (hand_ + 1) % ring_.size();
+            Slot &s = ring_[hand_];
+            if (s.frame == NONE || !evictable(s.frame)) continue;
+            if (s.referenced.exchange(false, std::memory_order_relaxed)) continue;
+            frameId = s.frame;
+            remove(frameId);
+            return true;
+        }
+        return false;
+    }
+
+    void upcomingVictims(const std::function<bool(std::size_t)> &evictable,
+                         std::size_t n, std::vector<std::size_t> &out) const override {
+        // Unreferenced frames go in hand order on the first sweep; the
+        // referenced ones only after the sweep has cleared their bits
+        for (int pass = 0; pass < 2; ++pass) {
+            for (std::size_t i = 1; i <= ring_.size() && n > 0; ++i) {
+                const Slot &s = ring_[(hand_ + i) % ring_.size()];
+                if (s.frame == NONE || !evictable(s.frame)) continue;
+                if (s.referenced.load(std::memory_order_relaxed) != (pass == 1)) continue;
+                out.push_back(s.frame);
+                --n;
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+    struct Slot {
+        std::size_t frame = NONE;
+        std::atomic<bool> referenced{false};
+    };
+    std::deque<Slot> ring_;
+    std::vector<std::size_t> freeSlots_;
+    std::unordered_map<std::size_t, std::size_t> slotOf_;
+    std::size_t hand_ = 0;
+};
+
+// ---------------------------------------------------------------- LRU-K ---
+
+// LRU-2 with retained history: the reference times of recently evicted
+// pages are remembered, so a page that comes back quickly is recognized
+// as hot instead of starting over as a one-time reference.
+class LruKPolicy : public ReplacementPolicy {
+public:
+    static constexpr int K = 2;
+
+    const char *name() const override { return "LRU-2"; }
+
+    void setCapacity(std::size_t frames) override { historyLimit_ = frames; }
+
+    void recordLoad(std::size_t frameId, std::uint64_t pageKey) override {
+        Entry e;
+        e.pageKey = pageKey;
+        auto h = retained_.find(pageKey);
+        if (h != retained_.end()) {
+            e.times = h->second.times;
+            retained_.erase(h);
+        }
+        touch(e.times);
+        entries_[frameId] = e;
+        order_.insert(keyOf(e, frameId));
+    }
+
+    void recordAccess(std::size_t frameId) override {
+        auto it = entries_.find(frameId);
+        if (it == entries_.end()) return;
+        order_.erase(keyOf(it->second, frameId));
+        touch(it->second.times);
+        order_.insert(keyOf(it->second, frameId));
+    }
+
+    void remove(std::size_t frameId) override {
+        auto it = entries_.find(frameId);
+        if (it == entries_.end()) return;
+        order_.erase(keyOf(it->second, frameId));
+        entries_.erase(it);
+    }
+
+    bool evict(const std::function<bool(std::size_t)> &evictable,
+               std::size_t &frameId) override {
+        // order_ is sorted by K-th most recent access (0 = fewer than K
+        // references, i.e. infinite backward K-distance), then by last access
+        for (auto key = order_.begin(); key != order_.end(); ++key) {
+            std::size_t f = std::get<2>(*key);
+            if (!evictable(f)) continue;
+            frameId = f;
+            auto it = entries_.find(f);
+            retain(it->second);
+            order_.erase(key);
+            entries_.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    void upcomingVictims(const std::function<bool(std::size_t)> &evictable,
+                         std::size_t n, std::vector<std::size_t> &out) const override {
+        for (auto key = order_.begin(); key != order_.end() && n > 0; ++key) {
+            std::size_t f = std::get<2>(*key);
+            if (!evictable(f)) continue;
+            out.push_back(f);
+            --n;
+        }
+    }
+
+private:
+    // times[0] is the most recent access; 0 = never
+    using History = std::array<std::uint64_t, K>;
+    struct Entry {
+        std::uint64_t pageKey = 0;
+        History times{};
+    };
+    struct Retained {
+        History times;
+        std::uint64_t seq;  // matches the newest retainedOrder_ entry for the key
+    };
+    using OrderKey = std::tuple<std::uint64_t, std::uint64_t, std::size_t>;
+
+    std::uint64_t clock_ = 0;
+    std::unordered_map<std::size_t, Entry> entries_;
+    std::set<OrderKey> order_;
+    // History of evicted pages, bounded to historyLimit_ entries (FIFO)
+    std::unordered_map<std::uint64_t, Retained> retained_;
+    std::deque<std::pair<std::uint64_t, std::uint64_t>> retainedOrder_;  // (key, seq)
+    std::uint64_t retainSeq_ = 0;
+    std::size_t historyLimit_ = 0;
+
+    void touch(History &times) {
+        for (int i = K - 1; i > 0; --i) times[i] = times[i - 1];
+        times[0] = ++clock_;
+    }
+
+    static OrderKey keyOf(const Entry &e, std::size_t frameId) {
+        return OrderKey{e.times[K - 1], e.times[0], frameId};
+    }
+
+    void retain(const Entry &e) {
+        if (historyLimit_ == 0) return;
+        retained_[e.pageKey] = Retained{e.times, ++retainSeq_};
+        retainedOrder_.emplace_back(e.pageKey, retainSeq_);
+        while (retainedOrder_.size() > historyLimit_) {
+            // Stale queue entries (the key was reloaded or retained again
+            // since) must not drop the newer history
+            auto old = retainedOrder_.front();
+            retainedOrder_.pop_front();
+            auto it = retained_.find(old.first);
+            if (it != retained_.end() && it->second.seq == old.second) retained_.erase(it);
+        }
+    }
+};
+
+// ------------------------------------------------------------------- 2Q ---
+
+// Full 2Q (Johnson & Shasha): a page seen once sits in the A1in FIFO and is
+// evicted from there without disturbing the hot pages in Am. Page keys
+// evicted from A1in are remembered in the A1out ghost queue; a page that
+// is loaded again while still in A1out goes straight to Am. A sequential
+// scan therefore only ever cycles through A1in.
+class TwoQPolicy : public ReplacementPolicy {
+public:
+    const char *name() const override { return "2Q"; }
+
+    void setCapacity(std::size_t frames) override {
+        kin_ = std::max<std::size_t>(1, frames / 4);
+        kout_ = std::max<std::size_t>(1, frames / 2);
+    }
+
+    void recordLoad(std::size_t frameId, std::uint64_t pageKey) override {
+        Entry e;
+        e.pageKey = pageKey;
+        auto ghost = ghostIndex_.find(pageKey);
+        if (ghost != ghostIndex_.end()) {
+            a1out_.erase(ghost->second);
+            ghostIndex_.erase(ghost);
+            e.hot = true;
+            e.pos = am_.insert(am_.end(), frameId);
+        } else {
+            e.pos = a1in_.insert(a1in_.end(), frameId);
+        }
+        entries_[frameId] = e;
+    }
+
+    void recordAccess(std::size_t frameId) override {
+        auto it = entries_.find(frameId);
+        // Re-references while in A1in are treated as correlated: no promotion
+        if (it == entries_.end() || !it->second.hot) return;
+        am_.splice(am_.end(), am_, it->second.pos);
+    }
+
+    void remove(std::size_t frameId) override {
+        auto it = entries_.find(frameId);
+        if (it == entries_.end()) return;
+        (it->second.hot ? am_ : a1in_).erase(it->second.pos);
+        entries_.erase(it);
+    }
+
+    bool evict(const std::function<bool(std::size_t)> &evictable,
+               std::size_t &frameId) override {
+        bool fromA1in = a1in_.size() > kin_ || am_.empty();
+        if (takeFrom(fromA1in ? a1in_ : am_, evictable, frameId, fromA1in)) return true;
+        return takeFrom(fromA1in ? am_ : a1in_, evictable, frameId, !fromA1in);
+    }
+
+    void upcomingVictims(const std::function<bool(std::size_t)> &evictable,
+                         std::size_t n, std::vector<std::size_t> &out) const override {
+        // A1in drains down to kin first, then Am, then the rest of A1in
+        std::size_t excess = a1in_.size() > kin_ ? a1in_.size() - kin_ : 0;
+        auto it = a1in_.begin();
+        for (; it != a1in_.end() && excess > 0 && n > 0; ++it, --excess) {
+            if (evictable(*it)) { out.push_back(*it); --n; }
+        }
+        for (auto am = am_.begin(); am != am_.end() && n > 0; ++am) {
+            if (evictable(*am)) { out.push_back(*am); --n; }
+        }
+        for (; it != a1in_.end() && n > 0; ++it) {
+            if (evictable(*it)) { out.push_back(*it); --n; }
+        }
+    }
+
+private:
+    struct Entry {
+        std::uint64_t pageKey = 0;
+        bool hot = false;  // in Am rather than A1in
+        std::list<std::size_t>::iterator pos;
+    };
+
+    std::size_t kin_ = 1, kout_ = 1;
+    std::list<std::size_t> a1in_;  // FIFO, oldest first
+    std::list<std::size_t> am_;    // LRU, least recent first
+    std::unordered_map<std::size_t, Entry> entries_;
+    std::list<std::uint64_t> a1out_;  // ghost FIFO of page keys
+    std::unordered_map<std::uint64_t, std::list<std::uint64_t>::iterator> ghostIndex_;
+
+    bool takeFrom(std::list<std::size_t> &queue,
+                  const std::function<bool(std::size_t)> &evictable,
+                  std::size_t &frameId, bool isA1in) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (!evictable(*it)) continue;
+            frameId = *it;
+            auto e = entries_.find(frameId);
+            if (isA1in) remember(e->second.pageKey);
+            queue.erase(it);
+            entries_.erase(e);
+            return true;
+        }
+        return false;
+    }
+
+    void remember(std::uint64_t pageKey) {
+        if (ghostIndex_.count(pageKey)) return;
+        ghostIndex_[pageKey] = a1out_.insert(a1out_.end(), pageKey);
+        while (a1out_.size() > kout_) {
+            ghostIndex_.erase(a1out_.front());
+            a1out_.pop_front();
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<ReplacementPolicy> ReplacementPolicy::create(ReplacementPolicyKind kind,
+                                                             std::size_t capacity) {
+    std::unique_ptr<ReplacementPolicy> p;
+    switch (kind) {
+        case ReplacementPolicyKind::CLOCK: p = std::make_unique<ClockPolicy>(); break;
+        case ReplacementPolicyKind::LRU_K: p = std::make_unique<LruKPolicy>(); break;
+        case ReplacementPolicyKind::TWO_Q: p = std::make_unique<TwoQPolicy>(); break;
+        default: throw std::runtime_error("Unknown replacement policy");
+    }
+    p->setCapacity(capacity);
+    return p;
+}
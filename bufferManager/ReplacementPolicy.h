@@ -0,0 +1,54 @@
+// File: ReplacementPolicy.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Which page-replacement algorithm a buffer pool shard uses
+enum class ReplacementPolicyKind {
+    CLOCK,   // second chance: one reference bit per frame
+    LRU_K,   // LRU-2: evicts the page whose 2nd-most-recent access is oldest
+    TWO_Q    // 2Q: first-touch pages stay in a FIFO until referenced again
+};
+
+// Decides which resident frame a buffer pool shard evicts next. A policy
+// tracks only frames that currently hold a page, identified by their global
+// frame id; free frames are the pool's business.
+//
+// The pool calls recordLoad/remove/evict under its shard latch held
+// exclusively. recordAccess runs on the hit path under the shared latch:
+// policies that cannot take concurrent recordAccess calls return false
+// from concurrentAccess() and the pool serializes those calls for them.
+class ReplacementPolicy {
+public:
+    virtual ~ReplacementPolicy() = default;
+
+    static std::unique_ptr<ReplacementPolicy> create(ReplacementPolicyKind kind,
+                                                     std::size_t capacity);
+
+    virtual const char *name() const = 0;
+    // True if recordAccess may run on several threads at once
+    virtual bool concurrentAccess() const { return false; }
+
+    // Frames managed by the owning shard; sizes queues and history
+    virtual void setCapacity(std::size_t frames) = 0;
+    // frameId was just filled with the page identified by pageKey (a miss)
+    virtual void recordLoad(std::size_t frameId, std::uint64_t pageKey) = 0;
+    // The page in frameId was requested again (a hit)
+    virtual void recordAccess(std::size_t frameId) = 0;
+    // frameId stopped holding a page without being chosen by evict()
+    virtual void remove(std::size_t frameId) = 0;
+    // Picks a frame to evict among those for which evictable(frameId) is
+    // true and stops tracking it. Returns false if every frame is pinned.
+    virtual bool evict(const std::function<bool(std::size_t)> &evictable,
+                       std::size_t &frameId) = 0;
+    // Appends up to n frames that evict() would pick next, soonest first,
+    // without changing any state. Used by the background writer to clean
+    // victims before a miss needs them. Runs under the shared latch (and
+    // the pool's policy latch for policies without concurrentAccess).
+    virtual void upcomingVictims(const std::function<bool(std::size_t)> &evictable,
+                                 std::size_t n, std::vector<std::size_t> &out) const = 0;
+};
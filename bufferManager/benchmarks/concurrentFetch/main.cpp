@@ -0,0 +1,79 @@
+// Stress benchmark for concurrent buffer pool hits: every thread fetches
+// and unpins random pages of a working set that fits in the pool, so the
+// run measures latch contention rather than I/O. Compares a single-shard
+// pool (one global latch) with the default sharded pool.
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BufferManager.h"
+
+namespace {
+
+constexpr int WORKING_SET = 1024;      // pages
+constexpr std::size_t POOL = 2048;     // frames
+constexpr auto RUN_TIME = std::chrono::milliseconds(500);
+
+double fetchesPerSecond(BufferManager &bm, int fileId, unsigned threads) {
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned long long> total{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> page(0, WORKING_SET - 1);
+            unsigned long long n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                int pid = page(rng);
+                char *data = bm.fetchPage(fileId, pid);
+                if (data[0] == 0x7f) std::putchar('.');  // keep the read
+                bm.unpinPage(fileId, pid);
+                ++n;
+            }
+            total += n;
+        });
+    }
+    std::this_thread::sleep_for(RUN_TIME);
+    stop = true;
+    for (auto &w : workers) w.join();
+    return total.load() / std::chrono::duration<double>(RUN_TIME).count();
+}
+
+} // namespace
+
+int main() {
+    const char *path = "concurrent_fetch.dat";
+    std::remove(path);
+    FileManager fm;
+    int fileId = fm.openFile(path);
+    std::vector<char> page(FileManager::PAGE_SIZE, 1);
+    for (int i = 0; i < WORKING_SET; ++i) {
+        fm.writePage(fileId, fm.allocatePage(fileId), page.data());
+    }
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    {
+        BufferManager single(fm, POOL, 1);
+        BufferManager sharded(fm, POOL);
+        // Warm both pools so every fetch is a hit
+        for (int i = 0; i < WORKING_SET; ++i) {
+            single.fetchPage(fileId, i);  single.unpinPage(fileId, i);
+            sharded.fetchPage(fileId, i); sharded.unpinPage(fileId, i);
+        }
+        std::cout << "threads  1-shard Mops/s  sharded Mops/s ("
+                  << sharded.numShards() << " shards)\n";
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            double a = fetchesPerSecond(single, fileId, threads);
+            double b = fetchesPerSecond(sharded, fileId, threads);
+            std::cout << std::setw(7) << threads << std::fixed << std::setprecision(2)
+                      << std::setw(16) << a / 1e6 << std::setw(16) << b / 1e6 << "\n";
+        }
+    }
+    fm.closeFile(fileId);
+    std::remove(path);
+    return 0;
+}
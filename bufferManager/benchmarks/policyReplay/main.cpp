@@ -0,0 +1,137 @@
+// Trace-replay harness for buffer replacement policies. Replays a page
+// reference trace through a BufferManager once per policy and reports the
+// hit ratio, overall and for point-lookup ("OLTP") references only. Each
+// policy runs twice: with scan references fetched like any other, and with
+// them fetched through the BULK_READ ring.
+//
+// Usage: policyReplay [poolPages] [traceFile]
+//   traceFile lines: "<file> <page> [S]" where file is a small integer and
+//   a trailing S marks a reference made by a scan. Without a trace file a
+//   synthetic mixed load is generated: Zipf-skewed lookups on an index and
+//   a heap, interleaved with periodic full scans of a large reporting table.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "BufferManager.h"
+
+namespace {
+
+struct Ref {
+    int file;
+    int page;
+    bool scan;
+};
+
+std::vector<Ref> loadTrace(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open trace: " + path);
+    std::vector<Ref> refs;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        Ref r{0, 0, false};
+        std::string tag;
+        if (!(ls >> r.file >> r.page)) continue;
+        r.scan = (ls >> tag) && tag == "S";
+        refs.push_back(r);
+    }
+    return refs;
+}
+
+// Zipf(s=1) over [0, n) by inverse CDF
+class Zipf {
+public:
+    explicit Zipf(int n) : cdf_(n) {
+        double sum = 0;
+        for (int i = 0; i < n; ++i) cdf_[i] = (sum += 1.0 / (i + 1));
+        for (auto &c : cdf_) c /= sum;
+    }
+    int operator()(std::mt19937 &rng) {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return static_cast<int>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+private:
+    std::vector<double> cdf_;
+};
+
+std::vector<Ref> syntheticTrace() {
+    constexpr int INDEX_PAGES = 200, HEAP_PAGES = 2000, REPORT_PAGES = 3000;
+    constexpr int LOOKUPS = 200000, SCAN_EVERY = 40000;
+    std::mt19937 rng(7);
+    Zipf hotIndex(INDEX_PAGES), hotHeap(HEAP_PAGES);
+    std::vector<Ref> refs;
+    for (int i = 0; i < LOOKUPS; ++i) {
+        if (i % SCAN_EVERY == SCAN_EVERY / 2) {
+            for (int p = 0; p < REPORT_PAGES; ++p) refs.push_back({2, p, true});
+        }
+        // Root and inner pages first, then a leaf, then the heap page
+        refs.push_back({0, 0, false});
+        refs.push_back({0, 1 + hotIndex(rng) % (INDEX_PAGES - 1), false});
+        refs.push_back({1, hotHeap(rng), false});
+    }
+    return refs;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t poolPages = argc > 1 ? std::stoul(argv[1]) : 256;
+    std::vector<Ref> refs = argc > 2 ? loadTrace(argv[2]) : syntheticTrace();
+
+    // Back every trace file with a real file large enough for its pages.
+    // Pages are only reserved, never written, so setup costs no I/O.
+    std::map<int, int> pagesPerFile;
+    for (const Ref &r : refs) {
+        pagesPerFile[r.file] = std::max(pagesPerFile[r.file], r.page + 1);
+    }
+    FileManager fm;
+    std::map<int, int> fileIds;
+    std::vector<std::string> paths;
+    for (auto &kv : pagesPerFile) {
+        paths.push_back("policy_replay_" + std::to_string(kv.first) + ".dat");
+        std::remove(paths.back().c_str());
+        int fid = fm.openFile(paths.back());
+        fm.setExtentSize(fid, kv.second);
+        for (int p = 0; p < kv.second; ++p) fm.allocatePage(fid);
+        fileIds[kv.first] = fid;
+    }
+
+    std::cout << refs.size() << " references, " << poolPages << " frames\n"
+              << "policy   scans      hit%     oltp hit%\n";
+    for (ReplacementPolicyKind kind : {ReplacementPolicyKind::CLOCK,
+                                       ReplacementPolicyKind::LRU_K,
+                                       ReplacementPolicyKind::TWO_Q})
+    for (AccessStrategy scanStrategy : {AccessStrategy::NORMAL, AccessStrategy::BULK_READ}) {
+        // One shard so the policy sees the whole trace, as in a small pool
+        BufferManager bm(fm, poolPages, 1, kind);
+        std::uint64_t oltpRefs = 0, oltpHits = 0;
+        for (const Ref &r : refs) {
+            int fid = fileIds[r.file];
+            std::uint64_t before = bm.hitCount();
+            bm.fetchPage(fid, r.page, r.scan ? scanStrategy : AccessStrategy::NORMAL);
+            bm.unpinPage(fid, r.page);
+            if (!r.scan) {
+                ++oltpRefs;
+                oltpHits += bm.hitCount() - before;
+            }
+        }
+        double all = 100.0 * bm.hitCount() / (bm.hitCount() + bm.missCount());
+        double oltp = oltpRefs ? 100.0 * oltpHits / oltpRefs : 0.0;
+        std::cout << std::left << std::setw(9) << bm.policyName()
+                  << std::setw(9)
+                  << (scanStrategy == AccessStrategy::NORMAL ? "normal" : "ring") << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(6) << all << std::setw(14) << oltp << "\n";
+    }
+
+    for (auto &kv : fileIds) fm.closeFile(kv.second);
+    for (auto &p : paths) std::remove(p.c_str());
+    return 0;
+}
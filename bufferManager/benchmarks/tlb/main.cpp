@@ -0,0 +1,150 @@
+// TLB benchmark for the buffer pool's frame arena: random point lookups
+// (fetch a resident page, read one slot-sized chunk, unpin) over a pool
+// that is fully warm, once with the arena on transparent huge pages and
+// once forced to 4 KiB pages. dTLB misses are counted with perf_event_open;
+// where the counter is unavailable (no PMU in the VM, perf_event_paranoid)
+// only the lookup rate is reported.
+//
+// Usage: tlb [poolPages] [lookups]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "BufferManager.h"
+
+namespace {
+
+// One hardware counter for this thread, user space only
+class PerfCounter {
+public:
+    PerfCounter(std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~PerfCounter() { if (fd_ >= 0) close(fd_); }
+    PerfCounter(const PerfCounter &) = delete;
+    PerfCounter &operator=(const PerfCounter &) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+    void start() {
+        if (!ok()) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    std::uint64_t stop() {
+        if (!ok()) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        std::uint64_t value = 0;
+        if (read(fd_, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+constexpr std::uint64_t DTLB_LOAD_MISSES =
+    PERF_COUNT_HW_CACHE_DTLB |
+    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+// Anonymous memory the kernel actually backs with huge pages, process-wide
+std::size_t anonHugeKiB() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string key;
+    std::size_t kib;
+    while (in >> key) {
+        if (key == "AnonHugePages:" && in >> kib) return kib;
+    }
+    return 0;
+}
+
+struct Result {
+    double lookupsPerSec;
+    std::uint64_t tlbMisses;
+    bool counted;
+    bool huge;
+    std::size_t hugeKiB;
+};
+
+Result run(FileManager &fm, int fileId, std::size_t poolPages, long lookups, bool huge) {
+    // One shard: the lookup path, not latch spreading, is under test
+    BufferManager bm(fm, poolPages, 1, ReplacementPolicyKind::CLOCK, huge);
+    int pages = static_cast<int>(poolPages);
+    for (int p = 0; p < pages; ++p) {
+        bm.fetchPage(fileId, p);
+        bm.unpinPage(fileId, p);
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<std::uint32_t> order(1 << 20);
+    for (auto &o : order) o = static_cast<std::uint32_t>(rng());
+    PerfCounter misses(PERF_TYPE_HW_CACHE, DTLB_LOAD_MISSES);
+    std::uint64_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    misses.start();
+    for (long i = 0; i < lookups; ++i) {
+        std::uint32_t r = order[i & (order.size() - 1)];
+        int pid = static_cast<int>(r % pages);
+        char *data = bm.fetchPage(fileId, pid);
+        // A point lookup reads one record somewhere in the page
+        std::size_t off = (r >> 16) % (FileManager::USABLE_PAGE_SIZE / 64) * 64;
+        sink += static_cast<unsigned char>(data[off]);
+        bm.unpinPage(fileId, pid);
+    }
+    std::uint64_t counted = misses.stop();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 1) std::putchar('.');  // keep the reads
+    return {lookups / secs, counted, misses.ok(), bm.hugePages(), anonHugeKiB()};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t poolPages = argc > 1 ? std::stoul(argv[1]) : 65536;  // 512 MiB
+    long lookups = argc > 2 ? std::stol(argv[2]) : 5000000;
+
+    const char *path = "tlb_bench.dat";
+    std::remove(path);
+    FileManager fm;
+    int fid = fm.openFile(path);
+    fm.setExtentSize(fid, static_cast<int>(poolPages));
+    for (std::size_t p = 0; p < poolPages; ++p) fm.allocatePage(fid);
+
+    std::cout << poolPages << " frames ("
+              << poolPages * FileManager::PAGE_SIZE / (1 << 20) << " MiB), "
+              << lookups << " random lookups\n"
+              << "arena          Mlookups/s  dTLB misses/lookup  THP-backed MiB\n";
+    for (bool huge : {false, true}) {
+        Result r = run(fm, fid, poolPages, lookups, huge);
+        std::cout << std::left << std::setw(15)
+                  << (huge ? (r.huge ? "2MiB THP" : "2MiB (denied)") : "4KiB") << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(10)
+                  << r.lookupsPerSec / 1e6 << std::setw(20);
+        if (r.counted) std::cout << std::setprecision(3) << double(r.tlbMisses) / lookups;
+        else           std::cout << "n/a";
+        std::cout << std::setw(16) << r.hugeKiB / 1024 << "\n";
+    }
+
+    fm.closeFile(fid);
+    std::remove(path);
+    return 0;
+}
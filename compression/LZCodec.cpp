@@ -0,0 +1,154 @@
+// File: LZCodec.cpp
+#include "LZCodec.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t MIN_MATCH   = 4;
+constexpr std::size_t MAX_OFFSET  = 65535;
+constexpr int         HASH_BITS   = 12;
+
+inline std::uint32_t read32(const unsigned char *p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t hash32(std::uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Writes the 255-continued tail of a length whose nibble saturated at 15
+inline bool putLength(unsigned char *&op, unsigned char *oend, std::size_t len) {
+    while (len >= 255) {
+        if (op >= oend) return false;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) return false;
+    *op++ = static_cast<unsigned char>(len);
+    return true;
+}
+
+inline bool getLength(const unsigned char *&ip, const unsigned char *iend,
+                      std::size_t &len) {
+    unsigned char b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+// Emits one sequence; offset == 0 marks the final literals-only sequence
+bool emit(unsigned char *&op, unsigned char *oend,
+          const unsigned char *lit, std::size_t litLen,
+          std::size_t offset, std::size_t matchLen) {
+    if (op >= oend) return false;
+    unsigned char *token = op++;
+    std::size_t ml = offset ? matchLen - MIN_MATCH : 0;
+    *token = static_cast<unsigned char>(((litLen < 15 ? litLen : 15) << 4) |
+                                        (ml < 15 ? ml : 15));
+    if (litLen >= 15 && !putLength(op, oend, litLen - 15)) return false;
+    if (static_cast<std::size_t>(oend - op) < litLen) return false;
+    if (litLen) std::memcpy(op, lit, litLen);
+    op += litLen;
+    if (!offset) return true;
+    if (oend - op < 2) return false;
+    *op++ = static_cast<unsigned char>(offset & 0xFF);
+    *op++ = static_cast<unsigned char>(offset >> 8);
+    if (ml >= 15 && !putLength(op, oend, ml - 15)) return false;
+    return true;
+}
+
+} // namespace
+
+std::size_t LZCodec::maxCompressedSize(std::size_t srcLen) {
+    return srcLen + srcLen / 255 + 16;
+}
+
+std::size_t LZCodec::compress(const char *srcChars, std::size_t srcLen,
+                              char *dstChars, std::size_t dstCapacity) {
+    const unsigned char *src = reinterpret_cast<const unsigned char *>(srcChars);
+    unsigned char *op = reinterpret_cast<unsigned char *>(dstChars);
+    unsigned char *oend = op + dstCapacity;
+    const unsigned char *ip = src;
+    const unsigned char *anchor = src;
+    const unsigned char *end = src + srcLen;
+
+    if (srcLen > MIN_MATCH) {
+        std::uint32_t table[1u << HASH_BITS];
+        std::memset(table, 0, sizeof(table));
+        const unsigned char *limit = end - MIN_MATCH;  // last position read32 may touch
+        ++ip;  // position 0 is the table's implicit initial entry
+        while (ip <= limit) {
+            std::uint32_t seq = read32(ip);
+            std::uint32_t h = hash32(seq);
+            const unsigned char *ref = src + table[h];
+            table[h] = static_cast<std::uint32_t>(ip - src);
+            if (static_cast<std::size_t>(ip - ref) > MAX_OFFSET || read32(ref) != seq) {
+                ++ip;
+                continue;
+            }
+            const unsigned char *mp = ip + MIN_MATCH;
+            const unsigned char *rp = ref + MIN_MATCH;
+            while (mp < end && *mp == *rp) { ++mp; ++rp; }
+            if (!emit(op, oend, anchor, static_cast<std::size_t>(ip - anchor),
+                      static_cast<std::size_t>(ip - ref),
+                      static_cast<std::size_t>(mp - ip))) {
+                return 0;
+            }
+            ip = anchor = mp;
+            if (ip - 2 >= src && ip <= limit) {
+                table[hash32(read32(ip - 2))] = static_cast<std::uint32_t>(ip - 2 - src);
+            }
+        }
+    }
+    if (!emit(op, oend, anchor, static_cast<std::size_t>(end - anchor), 0, 0)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(op - reinterpret_cast<unsigned char *>(dstChars));
+}
+
+std::size_t LZCodec::decompress(const char *srcChars, std::size_t srcLen,
+                                char *dstChars, std::size_t dstCapacity) {
+    const unsigned char *ip = reinterpret_cast<const unsigned char *>(srcChars);
+    const unsigned char *iend = ip + srcLen;
+    unsigned char *dst = reinterpret_cast<unsigned char *>(dstChars);
+    unsigned char *op = dst;
+    unsigned char *oend = dst + dstCapacity;
+    auto corrupt = []() { return std::runtime_error("LZCodec: corrupt input"); };
+
+    while (ip < iend) {
+        unsigned char token = *ip++;
+        std::size_t litLen = token >> 4;
+        if (litLen == 15 && !getLength(ip, iend, litLen)) throw corrupt();
+        if (static_cast<std::size_t>(iend - ip) < litLen ||
+            static_cast<std::size_t>(oend - op) < litLen) {
+            throw corrupt();
+        }
+        if (litLen) std::memcpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == iend) break;  // final sequence carries no match
+
+        if (iend - ip < 2) throw corrupt();
+        std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        std::size_t matchLen = token & 0x0F;
+        if (matchLen == 15 && !getLength(ip, iend, matchLen)) throw corrupt();
+        matchLen += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dst) ||
+            static_cast<std::size_t>(oend - op) < matchLen) {
+            throw corrupt();
+        }
+        // Byte copy: source and destination overlap for short offsets
+        const unsigned char *ref = op - offset;
+        for (std::size_t i = 0; i < matchLen; ++i) op[i] = ref[i];
+        op += matchLen;
+    }
+    return static_cast<std::size_t>(op - dst);
+}
@@ -0,0 +1,31 @@
+// File: LZCodec.h
+#pragma once
+
+#include <cstddef>
+
+// Small LZ77 byte codec in the LZ4 block style: a greedy single-probe hash
+// matcher and sequences of (literal run, 16-bit back-reference). Tuned for
+// speed over ratio; pages full of zero padding collapse to a few bytes.
+//
+// Sequence format:
+//   token      : high nibble = literal length, low nibble = match length - 4
+//                (15 in either nibble means "more length bytes follow")
+//   [lit len]  : 255-continued extra literal length bytes
+//   literals
+//   offset     : 2 bytes little-endian, 1..65535 (absent in the last sequence)
+//   [match len]: 255-continued extra match length bytes
+class LZCodec {
+public:
+    // Upper bound on compress() output for srcLen input bytes
+    static std::size_t maxCompressedSize(std::size_t srcLen);
+
+    // Compresses src into dst. Returns the compressed size, or 0 if the
+    // result would not fit in dstCapacity (caller stores the data raw).
+    static std::size_t compress(const char *src, std::size_t srcLen,
+                                char *dst, std::size_t dstCapacity);
+
+    // Decompresses src into dst. Returns the decompressed size; throws
+    // std::runtime_error on malformed input or if dstCapacity is too small.
+    static std::size_t decompress(const char *src, std::size_t srcLen,
+                                  char *dst, std::size_t dstCapacity);
+};
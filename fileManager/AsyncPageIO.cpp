@@ -0,0 +1,311 @@
+// File: AsyncPageIO.cpp
+#include "AsyncPageIO.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define SQL_ENGINE_HAVE_IO_URING 1
+#endif
+#endif
+
+namespace {
+
+// Services a request through FileManager's synchronous path. FileManager
+// reports failures by throwing, so errno means nothing here: map the
+// exception to a completion code instead.
+int runSync(FileManager &fm, const PageRequest &req) {
+    try {
+        if (req.isWrite) fm.writePage(req.fileId, req.pageId, req.buffer);
+        else             fm.readPage(req.fileId, req.pageId, req.buffer);
+        return 0;
+    } catch (const PageChecksumError &) {
+        return -EBADMSG;
+    } catch (const std::exception &) {
+        return -EIO;
+    }
+}
+
+} // namespace
+
+#ifdef SQL_ENGINE_HAVE_IO_URING
+
+// Minimal io_uring wrapper over the raw syscalls (no liburing dependency).
+struct AsyncPageIO::Ring {
+    int fd = -1;
+    void *sqMap = nullptr;  std::size_t sqMapLen = 0;
+    void *cqMap = nullptr;  std::size_t cqMapLen = 0;
+    io_uring_sqe *sqes = nullptr; std::size_t sqesLen = 0;
+
+    unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+    unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+    unsigned sqEntries = 0;
+    unsigned toSubmit = 0;
+
+    // Returns nullptr if the kernel does not support io_uring
+    static std::unique_ptr<Ring> create(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd < 0) return nullptr;
+
+        auto r = std::make_unique<Ring>();
+        r->fd = fd;
+        r->sqEntries = p.sq_entries;
+        r->sqMapLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        r->cqMapLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            r->sqMapLen = r->cqMapLen = std::max(r->sqMapLen, r->cqMapLen);
+        }
+        r->sqMap = ::mmap(nullptr, r->sqMapLen, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (r->sqMap == MAP_FAILED) { r->sqMap = nullptr; return nullptr; }
+        if (single) {
+            r->cqMap = r->sqMap;
+        } else {
+            r->cqMap = ::mmap(nullptr, r->cqMapLen, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (r->cqMap == MAP_FAILED) { r->cqMap = nullptr; return nullptr; }
+        }
+        r->sqesLen = p.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, r->sqesLen, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return nullptr;
+        r->sqes = static_cast<io_uring_sqe *>(sqes);
+
+        char *sq = static_cast<char *>(r->sqMap);
+        r->sqHead  = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        r->sqTail  = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        r->sqMask  = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        r->sqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        char *cq = static_cast<char *>(r->cqMap);
+        r->cqHead = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        r->cqTail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        r->cqMask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        r->cqes   = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+        return r;
+    }
+
+    ~Ring() {
+        if (sqes) ::munmap(sqes, sqesLen);
+        if (cqMap && cqMap != sqMap) ::munmap(cqMap, cqMapLen);
+        if (sqMap) ::munmap(sqMap, sqMapLen);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // Fills the next submission slot; the caller guarantees there is room.
+    void prepare(bool isWrite, int fileFd, char *buf, unsigned len,
+                 off_t offset, std::uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & *sqMask;
+        io_uring_sqe &sqe = sqes[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = isWrite ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = fileFd;
+        sqe.off = static_cast<std::uint64_t>(offset);
+        sqe.addr = reinterpret_cast<std::uint64_t>(buf);
+        sqe.len = len;
+        sqe.user_data = userData;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++toSubmit;
+    }
+
+    // Submits everything prepared so far, optionally waiting for one completion.
+    int enter(bool wait) {
+        while (true) {
+            unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+            long rc = ::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                wait ? 1u : 0u, flags, nullptr, 0);
+            if (rc < 0) {
+                if (errno == EINTR) continue;
+                return -errno;
+            }
+            toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(rc));
+            return 0;
+        }
+    }
+
+    // Pops one completion; returns false if the queue is empty.
+    bool pop(std::uint64_t &userData, int &res) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        if (head == tail) return false;
+        const io_uring_cqe &cqe = cqes[head & *cqMask];
+        userData = cqe.user_data;
+        res = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+#else
+
+struct AsyncPageIO::Ring {};
+
+#endif
+
+AsyncPageIO::AsyncPageIO(FileManager &fm, unsigned queueDepth)
+    : fm_(fm), depth_(std::max(1u, queueDepth)) {
+#ifdef SQL_ENGINE_HAVE_IO_URING
+    ring_ = Ring::create(depth_);
+    if (ring_) depth_ = std::min(depth_, ring_->sqEntries);
+#endif
+    slots_.resize(depth_);
+    for (std::size_t i = depth_; i-- > 0;) freeSlots_.push_back(i);
+}
+
+AsyncPageIO::~AsyncPageIO() {
+    // The kernel may still write into caller buffers; wait them out
+    std::vector<PageCompletion> ignored;
+    try { drain(ignored); } catch (...) {}
+}
+
+void AsyncPageIO::submitSync(PageRequest &req) {
+    int result = runSync(fm_, req);
+    ready_.push_back({{req.tag, req.fileId, req.pageId, result},
+                      std::move(req.onComplete)});
+    ++inFlight_;
+}
+
+void AsyncPageIO::submit(std::vector<PageRequest> requests) {
+#ifdef SQL_ENGINE_HAVE_IO_URING
+    for (auto &req : requests) {
+        if (!ring_ || ringBroken_) {
+            submitSync(req);
+            continue;
+        }
+        if (req.pageId < 0) {
+            // Let FileManager apply its out-of-range semantics
+            submitSync(req);
+            continue;
+        }
+        auto file = fm_.getEntry(req.fileId);
+        if (file->compressed) {
+            // Pages have to be (de)compressed on the CPU anyway
+            submitSync(req);
+            continue;
+        }
+        if (file->direct && !FileManager::isAligned(req.buffer)) {
+            // O_DIRECT rejects unaligned buffers; readPage/writePage bounce
+            submitSync(req);
+            continue;
+        }
+        if (freeSlots_.empty()) {
+            // Queue is full: push what we have and make room. What is
+            // reaped here waits in ready_ for the next poll().
+            int rc = ring_->enter(true);
+            if (rc < 0) throw std::runtime_error("io_uring_enter failed: " +
+                                                 std::string(std::strerror(-rc)));
+            reapRing(false);
+            if (freeSlots_.empty()) reapRing(true);
+        }
+        if (req.isWrite && file->checksums) {
+            FileManager::stampTrailer(req.buffer, req.pageId);
+        }
+        std::size_t slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        Pending &p = slots_[slot];
+        p.file = std::move(file);
+        p.req = std::move(req);
+        p.busy = true;
+        ring_->prepare(p.req.isWrite, p.file->fd, p.req.buffer,
+                       static_cast<unsigned>(FileManager::PAGE_SIZE),
+                       FileManager::pageOffset(p.req.pageId), slot);
+        ++inFlight_;
+    }
+    if (ring_ && ring_->toSubmit > 0) {
+        int rc = ring_->enter(false);
+        if (rc < 0) throw std::runtime_error("io_uring_enter failed: " +
+                                             std::string(std::strerror(-rc)));
+    }
+#else
+    for (auto &req : requests) submitSync(req);
+#endif
+}
+
+void AsyncPageIO::complete(std::size_t slot, int result) {
+    Pending &p = slots_[slot];
+    PageRequest req = std::move(p.req);
+    std::shared_ptr<FileManager::FileEntry> file = std::move(p.file);
+    p.busy = false;
+    freeSlots_.push_back(slot);
+
+    const int full = static_cast<int>(FileManager::PAGE_SIZE);
+    if (result == -EINVAL || result == -EOPNOTSUPP) {
+        // Kernel has io_uring but not this opcode: stop using the ring
+        ringBroken_ = true;
+        result = runSync(fm_, req);
+    } else if (result >= 0 && result < full) {
+        if (req.isWrite) {
+            // Short write: finish it synchronously
+            result = runSync(fm_, req);
+        } else {
+            // Read past end of file: zero the rest, like readPage
+            std::fill(req.buffer + result, req.buffer + full, 0);
+            result = 0;
+        }
+    } else if (result == full) {
+        result = 0;
+    }
+    if (result == 0 && !req.isWrite && file->checksums &&
+        !FileManager::trailerValid(req.buffer, req.pageId)) {
+        result = -EBADMSG;
+    }
+    // A write past the end grows the file, as writePage would have
+    if (result == 0 && req.isWrite) FileManager::noteWritten(*file, req.pageId);
+    file.reset();
+
+    // Still counted in flight until poll() delivers it
+    ready_.push_back({{req.tag, req.fileId, req.pageId, result},
+                      std::move(req.onComplete)});
+}
+
+std::size_t AsyncPageIO::reapRing(bool wait) {
+    std::size_t n = 0;
+#ifdef SQL_ENGINE_HAVE_IO_URING
+    if (!ring_) return 0;
+    std::uint64_t userData;
+    int res;
+    while (true) {
+        while (ring_->pop(userData, res)) {
+            complete(static_cast<std::size_t>(userData), res);
+            ++n;
+        }
+        if (n > 0 || !wait) break;
+        int rc = ring_->enter(true);
+        if (rc < 0) throw std::runtime_error("io_uring_enter failed: " +
+                                             std::string(std::strerror(-rc)));
+    }
+#else
+    (void)wait;
+#endif
+    return n;
+}
+
+std::size_t AsyncPageIO::poll(std::vector<PageCompletion> &out, bool wait) {
+    bool ringPending = inFlight_ > ready_.size();
+    reapRing(wait && ready_.empty() && ringPending);
+    std::size_t n = 0;
+    while (!ready_.empty()) {
+        Done d = std::move(ready_.front());
+        ready_.pop_front();
+        --inFlight_;
+        if (d.onComplete) d.onComplete(d.completion.result);
+        out.push_back(d.completion);
+        ++n;
+    }
+    return n;
+}
+
+void AsyncPageIO::drain(std::vector<PageCompletion> &out) {
+    while (inFlight_ > 0) poll(out, true);
+}
@@ -0,0 +1,96 @@
+// File: AsyncPageIO.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "FileManager.h"
+
+// One page read or write handed to AsyncPageIO. `buffer` must hold
+// PAGE_SIZE bytes and stay alive until the request completes. Writes stamp
+// the page checksum into the buffer's trailer bytes.
+struct PageRequest {
+    int fileId;
+    int pageId;
+    char *buffer;
+    bool isWrite = false;
+    // Opaque caller value echoed back in the completion
+    std::uint64_t tag = 0;
+    // Optional; invoked from poll() when the request completes, never from
+    // submit()
+    std::function<void(int result)> onComplete;
+};
+
+struct PageCompletion {
+    std::uint64_t tag;
+    int fileId;
+    int pageId;
+    // 0 on success, negative errno on failure (-EBADMSG: checksum mismatch)
+    int result;
+};
+
+// Batched asynchronous page I/O next to FileManager::readPage/writePage.
+// Requests are queued with submit() and reaped with poll(); on Linux the
+// batch goes to the kernel in a single io_uring_enter call. When io_uring is
+// unavailable (old kernel, seccomp, non-Linux) each request is serviced
+// synchronously with pread/pwrite at submit time and its completion is
+// delivered by the next poll(), so callers never need a separate code path.
+//
+// An instance is not thread-safe: give each I/O worker its own.
+class AsyncPageIO {
+public:
+    explicit AsyncPageIO(FileManager &fm, unsigned queueDepth = 64);
+    ~AsyncPageIO();
+    AsyncPageIO(const AsyncPageIO &) = delete;
+    AsyncPageIO &operator=(const AsyncPageIO &) = delete;
+
+    // Queues all requests and submits them in as few kernel calls as the
+    // queue depth allows. Blocks only when more than queueDepth requests
+    // would be in flight.
+    void submit(std::vector<PageRequest> requests);
+
+    // Reaps finished requests into `out` (appending) and runs their
+    // callbacks. With wait=true blocks until at least one completes, unless
+    // nothing is in flight. Returns the number reaped.
+    std::size_t poll(std::vector<PageCompletion> &out, bool wait = false);
+
+    // Waits for every in-flight request.
+    void drain(std::vector<PageCompletion> &out);
+
+    // Number of submitted requests not yet reaped
+    std::size_t inFlight() const { return inFlight_; }
+    // True if requests are going through io_uring
+    bool usingIoUring() const { return ring_ != nullptr && !ringBroken_; }
+
+private:
+    struct Ring;
+    struct Pending {
+        PageRequest req;
+        std::shared_ptr<FileManager::FileEntry> file;
+        bool busy = false;
+    };
+
+    FileManager &fm_;
+    unsigned depth_;
+    std::unique_ptr<Ring> ring_;
+    std::vector<Pending> slots_;
+    std::vector<std::size_t> freeSlots_;
+    std::size_t inFlight_ = 0;
+    // Set when the kernel rejects an opcode; new requests go synchronous
+    bool ringBroken_ = false;
+
+    // Finished requests (synchronous, or reaped from the ring) with their
+    // callbacks, counted in inFlight_ until poll() delivers them
+    struct Done {
+        PageCompletion completion;
+        std::function<void(int result)> onComplete;
+    };
+    std::deque<Done> ready_;
+
+    void submitSync(PageRequest &req);
+    std::size_t reapRing(bool wait);
+    void complete(std::size_t slot, int result);
+};
@@ -0,0 +1,212 @@
+// File: CompressedPageStore.cpp
+#include "CompressedPageStore.h"
+#include "FileManager.h"
+#include "LZCodec.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr std::size_t PAGE_SIZE = FileManager::PAGE_SIZE;
+// Blob prefix: low 31 bits = payload length, high bit = stored raw
+constexpr std::uint32_t RAW_FLAG = 0x80000000u;
+constexpr std::size_t BLOB_HEADER = sizeof(std::uint32_t);
+constexpr std::uint32_t MAX_SECTORS = static_cast<std::uint32_t>(
+    (PAGE_SIZE + BLOB_HEADER + CompressedPageStore::SECTOR_SIZE - 1) /
+    CompressedPageStore::SECTOR_SIZE);
+
+std::runtime_error ioError(const std::string &what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+std::size_t preadFull(int fd, char *buf, std::size_t len, off_t offset) {
+    std::size_t done = 0;
+    while (done < len) {
+        ssize_t n = ::pread(fd, buf + done, len - done, offset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("pread failed");
+        }
+        if (n == 0) break;
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+void pwriteFull(int fd, const char *buf, std::size_t len, off_t offset) {
+    std::size_t done = 0;
+    while (done < len) {
+        ssize_t n = ::pwrite(fd, buf + done, len - done, offset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("pwrite failed");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+// Per-thread blob buffer, large enough for a raw page plus its prefix
+char *blobScratch() {
+    thread_local std::vector<char> scratch(MAX_SECTORS * CompressedPageStore::SECTOR_SIZE);
+    return scratch.data();
+}
+
+} // namespace
+
+CompressedPageStore::CompressedPageStore(int dataFd, off_t dataStart,
+                                         const std::string &mapPath)
+    : dataFd_(dataFd), dataStart_(dataStart), mapPath_(mapPath),
+      freeRuns_(MAX_SECTORS + 1) {
+    mapFd_ = ::open(mapPath_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (mapFd_ < 0) throw ioError("Failed to open page map: " + mapPath_);
+    loadMap();
+}
+
+CompressedPageStore::~CompressedPageStore() {
+    if (mapFd_ >= 0) ::close(mapFd_);
+}
+
+void CompressedPageStore::loadMap() {
+    struct stat st;
+    if (::fstat(mapFd_, &st) != 0) throw ioError("fstat failed: " + mapPath_);
+    map_.resize(static_cast<std::size_t>(st.st_size) / sizeof(MapEntry));
+    if (!map_.empty()) {
+        std::size_t bytes = map_.size() * sizeof(MapEntry);
+        if (preadFull(mapFd_, reinterpret_cast<char *>(map_.data()), bytes, 0) != bytes) {
+            throw std::runtime_error("Short read of page map: " + mapPath_);
+        }
+    }
+
+    // Everything between the runs in use is free space
+    std::vector<MapEntry> used;
+    for (const auto &e : map_) {
+        if (e.sectors) used.push_back(e);
+    }
+    std::sort(used.begin(), used.end(),
+              [](const MapEntry &a, const MapEntry &b) { return a.sector < b.sector; });
+    std::uint32_t cursor = 0;
+    for (const auto &e : used) {
+        if (e.sector > cursor) addFreeRun(cursor, e.sector - cursor);
+        cursor = std::max(cursor, e.sector + e.sectors);
+    }
+    nextSector_ = cursor;
+}
+
+int CompressedPageStore::mappedPages() const {
+    std::lock_guard<std::mutex> guard(latch_);
+    return static_cast<int>(map_.size());
+}
+
+void CompressedPageStore::addFreeRun(std::uint32_t start, std::uint32_t sectors) {
+    while (sectors > 0) {
+        std::uint32_t n = std::min(sectors, MAX_SECTORS);
+        freeRuns_[n].push_back(start);
+        start += n;
+        sectors -= n;
+    }
+}
+
+std::uint32_t CompressedPageStore::allocateRun(std::uint32_t sectors) {
+    // Best fit: the smallest free run that is large enough
+    for (std::uint32_t n = sectors; n <= MAX_SECTORS; ++n) {
+        if (freeRuns_[n].empty()) continue;
+        std::uint32_t start = freeRuns_[n].back();
+        freeRuns_[n].pop_back();
+        if (n > sectors) addFreeRun(start + sectors, n - sectors);
+        return start;
+    }
+    std::uint32_t start = nextSector_;
+    nextSector_ += sectors;
+    return start;
+}
+
+void CompressedPageStore::readPage(int pageId, char *buffer) {
+    MapEntry e{0, 0};
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (pageId >= 0 && static_cast<std::size_t>(pageId) < map_.size()) {
+            e = map_[pageId];
+        }
+    }
+    if (e.sectors == 0) {
+        std::memset(buffer, 0, PAGE_SIZE);
+        return;
+    }
+
+    char *blob = blobScratch();
+    std::size_t len = e.sectors * SECTOR_SIZE;
+    std::size_t got = preadFull(dataFd_, blob, len, sectorOffset(e.sector));
+    std::uint32_t word;
+    if (got < BLOB_HEADER) throw std::runtime_error("Truncated compressed page");
+    std::memcpy(&word, blob, sizeof(word));
+    std::size_t payload = word & ~RAW_FLAG;
+    if (payload + BLOB_HEADER > got) throw std::runtime_error("Truncated compressed page");
+
+    if (word & RAW_FLAG) {
+        if (payload != PAGE_SIZE) throw std::runtime_error("Corrupt compressed page");
+        std::memcpy(buffer, blob + BLOB_HEADER, PAGE_SIZE);
+        return;
+    }
+    std::size_t n = LZCodec::decompress(blob + BLOB_HEADER, payload, buffer, PAGE_SIZE);
+    if (n != PAGE_SIZE) throw std::runtime_error("Corrupt compressed page");
+}
+
+void CompressedPageStore::writePage(int pageId, const char *buffer) {
+    if (pageId < 0) throw std::runtime_error("Invalid pageId");
+
+    // Compress outside the latch; fall back to raw if it does not pay off
+    char *blob = blobScratch();
+    std::size_t payload = LZCodec::compress(buffer, PAGE_SIZE, blob + BLOB_HEADER,
+                                            PAGE_SIZE - SECTOR_SIZE);
+    std::uint32_t word = static_cast<std::uint32_t>(payload);
+    if (payload == 0) {
+        std::memcpy(blob + BLOB_HEADER, buffer, PAGE_SIZE);
+        payload = PAGE_SIZE;
+        word = static_cast<std::uint32_t>(PAGE_SIZE) | RAW_FLAG;
+    }
+    std::memcpy(blob, &word, sizeof(word));
+    std::size_t blobLen = payload + BLOB_HEADER;
+    std::uint32_t needed = static_cast<std::uint32_t>(
+        (blobLen + SECTOR_SIZE - 1) / SECTOR_SIZE);
+
+    MapEntry target;
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (static_cast<std::size_t>(pageId) >= map_.size()) {
+            map_.resize(pageId + 1, MapEntry{0, 0});
+        }
+        MapEntry &e = map_[pageId];
+        if (e.sectors < needed) {
+            if (e.sectors) quarantined_.push_back(e);
+            e.sector = allocateRun(needed);
+            e.sectors = needed;
+            dirtyChunks_.insert(pageId / ENTRIES_PER_CHUNK);
+        }
+        target = e;
+    }
+    pwriteFull(dataFd_, blob, blobLen, sectorOffset(target.sector));
+}
+
+void CompressedPageStore::sync() {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (std::size_t chunk : dirtyChunks_) {
+        std::size_t first = chunk * ENTRIES_PER_CHUNK;
+        if (first >= map_.size()) continue;
+        std::size_t count = std::min(ENTRIES_PER_CHUNK, map_.size() - first);
+        pwriteFull(mapFd_, reinterpret_cast<const char *>(map_.data() + first),
+                   count * sizeof(MapEntry),
+                   static_cast<off_t>(first * sizeof(MapEntry)));
+    }
+    dirtyChunks_.clear();
+    while (::fdatasync(mapFd_) != 0) {
+        if (errno != EINTR) throw ioError("fdatasync failed: " + mapPath_);
+    }
+    // The persisted map no longer references these runs
+    for (const auto &e : quarantined_) addFreeRun(e.sector, e.sectors);
+    quarantined_.clear();
+}
@@ -0,0 +1,70 @@
+// File: CompressedPageStore.h
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// Storage for a compressed FileManager file. Each logical page is LZ
+// compressed and stored as a variable-size blob in a run of 512-byte
+// sectors after the file header; a page-mapping table (one entry per
+// logical page, kept in a sidecar "<file>.pmap") records where each blob
+// lives. Pages are only ever compressed on disk: readPage returns the full
+// uncompressed page.
+//
+// A rewrite that still fits its sectors is done in place; otherwise the
+// page moves to a new run and the old run is quarantined until the next
+// sync(), so the persisted map never points at reused space.
+class CompressedPageStore {
+public:
+    static constexpr std::size_t SECTOR_SIZE = 512;
+
+    // dataFd is the owning file; blobs start at byte offset dataStart
+    CompressedPageStore(int dataFd, off_t dataStart, const std::string &mapPath);
+    ~CompressedPageStore();
+    CompressedPageStore(const CompressedPageStore &) = delete;
+    CompressedPageStore &operator=(const CompressedPageStore &) = delete;
+
+    // Number of logical pages that have a map entry
+    int mappedPages() const;
+
+    // Reads and decompresses a page; never-written pages come back zeroed
+    void readPage(int pageId, char *buffer);
+    // Compresses and stores a page (raw if it does not compress)
+    void writePage(int pageId, const char *buffer);
+
+    // Persists dirty map entries (call after the data file is synced) and
+    // releases quarantined sectors for reuse
+    void sync();
+
+private:
+    struct MapEntry {
+        std::uint32_t sector;   // first sector of the blob
+        std::uint32_t sectors;  // sectors reserved; 0 = page never written
+    };
+
+    static constexpr std::size_t ENTRIES_PER_CHUNK = 512;  // 4 KiB of map
+
+    int dataFd_;
+    off_t dataStart_;
+    int mapFd_ = -1;
+    std::string mapPath_;
+
+    mutable std::mutex latch_;
+    std::vector<MapEntry> map_;
+    std::set<std::size_t> dirtyChunks_;
+    std::uint32_t nextSector_ = 0;
+    // freeRuns_[n] holds start sectors of free runs exactly n sectors long
+    std::vector<std::vector<std::uint32_t>> freeRuns_;
+    std::vector<MapEntry> quarantined_;
+
+    void loadMap();
+    void addFreeRun(std::uint32_t start, std::uint32_t sectors);
+    std::uint32_t allocateRun(std::uint32_t sectors);
+    off_t sectorOffset(std::uint32_t sector) const {
+        return dataStart_ + static_cast<off_t>(sector) * static_cast<off_t>(SECTOR_SIZE);
+    }
+};
@@ -0,0 +1,168 @@
+// File: Crc32c.cpp
+#include "Crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define SQL_ENGINE_HAVE_SSE42_CRC 1
+#endif
+
+namespace {
+
+constexpr std::uint32_t POLY = 0x82F63B78;  // reflected Castagnoli polynomial
+
+// Inputs at least this long are split into three interleaved streams
+constexpr std::size_t MIN_INTERLEAVED = 768;
+
+struct Tables {
+    std::uint32_t slice[8][256];
+    // xPow2[k] = x^(2^k) mod P, for shifting a CRC past n zero bytes
+    std::uint32_t xPow2[32];
+};
+
+// a * b mod P over GF(2), bit-reflected
+std::uint32_t multModP(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t m = 1u << 31, p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+const Tables &tables() {
+    static const Tables t = [] {
+        Tables t;
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ POLY : c >> 1;
+            t.slice[0][i] = c;
+        }
+        for (int s = 1; s < 8; ++s) {
+            for (int i = 0; i < 256; ++i) {
+                std::uint32_t c = t.slice[s - 1][i];
+                t.slice[s][i] = (c >> 8) ^ t.slice[0][c & 0xFF];
+            }
+        }
+        std::uint32_t p = 1u << 30;  // x^1
+        t.xPow2[0] = p;
+        for (int k = 1; k < 32; ++k) t.xPow2[k] = p = multModP(p, p);
+        return t;
+    }();
+    return t;
+}
+
+// x^(8 * bytes) mod P: multiplying a CRC by it appends `bytes` zero bytes
+std::uint32_t zeroShift(std::size_t bytes, const Tables &t) {
+    std::uint32_t p = 1u << 31;  // x^0
+    int k = 3;
+    while (bytes) {
+        if (bytes & 1) p = multModP(t.xPow2[k & 31], p);
+        bytes >>= 1;
+        ++k;
+    }
+    return p;
+}
+
+// CRC of A||B from crc(A) and crc(B) computed from zero
+inline std::uint32_t combine(std::uint32_t crcA, std::uint32_t crcB,
+                             std::uint32_t shiftB) {
+    return multModP(shiftB, crcA) ^ crcB;
+}
+
+// The lane length and its zero-shift constant; pages always hit the cache
+std::uint32_t laneShift(std::size_t lane, const Tables &t) {
+    thread_local std::size_t cachedLane = 0;
+    thread_local std::uint32_t cachedShift = 0;
+    if (lane != cachedLane) {
+        cachedShift = zeroShift(lane, t);
+        cachedLane = lane;
+    }
+    return cachedShift;
+}
+
+inline std::uint64_t load64(const unsigned char *p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t crcTable(const unsigned char *p, std::size_t len, std::uint32_t crc) {
+    const Tables &t = tables();
+    std::uint32_t s = ~crc;
+    while (len >= 8) {
+        std::uint64_t v = load64(p) ^ s;  // assumes little-endian, like the rest
+        s = t.slice[7][v & 0xFF] ^ t.slice[6][(v >> 8) & 0xFF] ^
+            t.slice[5][(v >> 16) & 0xFF] ^ t.slice[4][(v >> 24) & 0xFF] ^
+            t.slice[3][(v >> 32) & 0xFF] ^ t.slice[2][(v >> 40) & 0xFF] ^
+            t.slice[1][(v >> 48) & 0xFF] ^ t.slice[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) s = (s >> 8) ^ t.slice[0][(s ^ *p++) & 0xFF];
+    return ~s;
+}
+
+#ifdef SQL_ENGINE_HAVE_SSE42_CRC
+
+__attribute__((target("sse4.2")))
+std::uint32_t crcHardware(const unsigned char *p, std::size_t len, std::uint32_t crc) {
+    if (len >= MIN_INTERLEAVED) {
+        // crc32 has a 3-cycle latency but 1-cycle throughput: run three
+        // independent streams and stitch them together afterwards
+        const Tables &t = tables();
+        std::size_t lane = len / 24 * 8;
+        std::uint32_t shift = laneShift(lane, t);
+        std::uint64_t s0 = static_cast<std::uint32_t>(~crc);
+        std::uint64_t s1 = 0xFFFFFFFFu, s2 = 0xFFFFFFFFu;
+        const unsigned char *p1 = p + lane, *p2 = p + 2 * lane;
+        for (std::size_t i = 0; i < lane; i += 8) {
+            s0 = _mm_crc32_u64(s0, load64(p + i));
+            s1 = _mm_crc32_u64(s1, load64(p1 + i));
+            s2 = _mm_crc32_u64(s2, load64(p2 + i));
+        }
+        crc = combine(~static_cast<std::uint32_t>(s0),
+                      ~static_cast<std::uint32_t>(s1), shift);
+        crc = combine(crc, ~static_cast<std::uint32_t>(s2), shift);
+        p += 3 * lane;
+        len -= 3 * lane;
+    }
+    std::uint64_t s = static_cast<std::uint32_t>(~crc);
+    while (len >= 8) {
+        s = _mm_crc32_u64(s, load64(p));
+        p += 8;
+        len -= 8;
+    }
+    std::uint32_t s32 = static_cast<std::uint32_t>(s);
+    while (len--) s32 = _mm_crc32_u8(s32, *p++);
+    return ~s32;
+}
+
+#endif
+
+} // namespace
+
+std::uint32_t Crc32c::compute(const void *data, std::size_t len, std::uint32_t crc) {
+    const auto *p = static_cast<const unsigned char *>(data);
+#ifdef SQL_ENGINE_HAVE_SSE42_CRC
+    if (hardwareAccelerated()) return crcHardware(p, len, crc);
+#endif
+    return crcTable(p, len, crc);
+}
+
+std::uint32_t Crc32c::computePortable(const void *data, std::size_t len, std::uint32_t crc) {
+    return crcTable(static_cast<const unsigned char *>(data), len, crc);
+}
+
+bool Crc32c::hardwareAccelerated() {
+#ifdef SQL_ENGINE_HAVE_SSE42_CRC
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,21 @@
+// File: Crc32c.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32C (Castagnoli), the checksum stamped into page trailers. On x86-64
+// CPUs with SSE4.2 it runs on the crc32 instruction over three interleaved
+// streams, which hides the instruction's latency; elsewhere it falls back to
+// a slicing-by-8 table implementation. Both produce identical results.
+class Crc32c {
+public:
+    // Checksum of len bytes; pass a previous result as `crc` to continue it
+    static std::uint32_t compute(const void *data, std::size_t len,
+                                 std::uint32_t crc = 0);
+    // The table implementation, regardless of CPU support
+    static std::uint32_t computePortable(const void *data, std::size_t len,
+                                         std::uint32_t crc = 0);
+    // True if compute() uses the hardware instruction
+    static bool hardwareAccelerated();
+};
@@ -1,99 +1,890 @@
 // File: FileManager.cpp
 #include "FileManager.h"
+#include "CompressedPageStore.h"
+#include "Crc32c.h"
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
 
-int FileManager::openFile(const std::string &filePath) {
-    int fid = nextFileId_++;
-    FileEntry entry;
-    
-    // Try opening existing file
-    entry.stream.open(filePath, std::ios::in | std::ios::out | std::ios::binary);
-    if (!entry.stream.is_open()) {
-        // Create new file if not exists
-        std::ofstream create(filePath, std::ios::out | std::ios::binary);
-        create.close();
-        entry.stream.open(filePath, std::ios::in | std::ios::out | std::ios::binary);
-        if (!entry.stream.is_open()) {
-            throw std::runtime_error("Failed to create file: " + filePath);
+namespace {
+
+std::runtime_error ioError(const std::string &what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// pread until `len` bytes are read or EOF is hit; returns bytes read.
+std::size_t preadFull(int fd, char *buf, std::size_t len, off_t offset) {
+    std::size_t done = 0;
+    while (done < len) {
+        ssize_t n = ::pread(fd, buf + done, len - done, offset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("pread failed");
+        }
+        if (n == 0) break;  // EOF
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+// Fills iov from offset; stops early at EOF. Returns bytes read.
+std::size_t preadvFull(int fd, std::vector<struct iovec> &iov, off_t offset) {
+    std::size_t done = 0;
+    std::size_t idx = 0;
+    while (idx < iov.size()) {
+        ssize_t n = ::preadv(fd, iov.data() + idx, static_cast<int>(iov.size() - idx), offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("preadv failed");
+        }
+        if (n == 0) break;  // EOF
+        offset += n;
+        done += static_cast<std::size_t>(n);
+        std::size_t left = static_cast<std::size_t>(n);
+        while (idx < iov.size() && left >= iov[idx].iov_len) {
+            left -= iov[idx].iov_len;
+            ++idx;
         }
+        if (left > 0) {
+            iov[idx].iov_base = static_cast<char *>(iov[idx].iov_base) + left;
+            iov[idx].iov_len -= left;
+        }
+    }
+    return done;
+}
+
+void pwriteFull(int fd, const char *buf, std::size_t len, off_t offset) {
+    std::size_t done = 0;
+    while (done < len) {
+        ssize_t n = ::pwrite(fd, buf + done, len - done, offset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("pwrite failed");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+// pwritev until every iovec is written, advancing past partial writes.
+void pwritevFull(int fd, std::vector<struct iovec> &iov, off_t offset) {
+    std::size_t idx = 0;
+    while (idx < iov.size()) {
+        ssize_t n = ::pwritev(fd, iov.data() + idx,
+                              static_cast<int>(iov.size() - idx), offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("pwritev failed");
+        }
+        offset += n;
+        std::size_t left = static_cast<std::size_t>(n);
+        while (idx < iov.size() && left >= iov[idx].iov_len) {
+            left -= iov[idx].iov_len;
+            ++idx;
+        }
+        if (left > 0) {
+            iov[idx].iov_base = static_cast<char *>(iov[idx].iov_base) + left;
+            iov[idx].iov_len -= left;
+        }
+    }
+}
+
+// Per-thread aligned scratch page for direct I/O on unaligned caller buffers
+char *bouncePage() {
+    struct Bounce {
+        char *page = static_cast<char *>(
+            std::aligned_alloc(FileManager::IO_ALIGNMENT, FileManager::PAGE_SIZE));
+        ~Bounce() { std::free(page); }
+    };
+    thread_local Bounce b;
+    if (!b.page) throw std::bad_alloc();
+    return b.page;
+}
+
+// On-disk layout of the header page (physical page 0)
+constexpr std::uint32_t HEADER_MAGIC   = 0x464C5153;  // "SQLF"
+constexpr std::uint32_t FORMAT_VERSION = 1;
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t  pageCount;
+    std::int32_t  freeHead;
+    std::int32_t  freeCount;
+    // Older headers have zeros here
+    std::uint32_t flags;
+    std::uint32_t formatTag;
+};
+constexpr std::uint32_t FLAG_COMPRESSED = 1;
+constexpr std::uint32_t FLAG_CHECKSUMS  = 2;
+
+// Last PAGE_TRAILER_SIZE bytes of a checksummed page
+struct PageTrailer {
+    std::uint32_t checksum;  // CRC-32C of the first USABLE_PAGE_SIZE bytes
+    std::int32_t  pageId;    // catches pages written to the wrong offset
+};
+static_assert(sizeof(PageTrailer) == FileManager::PAGE_TRAILER_SIZE,
+              "Trailer layout must fill PAGE_TRAILER_SIZE");
+
+PageTrailer makeTrailer(const char *page, int pageId) {
+    return {Crc32c::compute(page, FileManager::USABLE_PAGE_SIZE), pageId};
+}
+
+// Staging area for direct writes of checksummed runs, which cannot gather
+// a trailer from outside the page; grows to the largest run seen
+char *stagingBuffer(std::size_t pages) {
+    struct Staging {
+        char *buf = nullptr;
+        std::size_t pages = 0;
+        ~Staging() { std::free(buf); }
+    };
+    thread_local Staging s;
+    if (pages > s.pages) {
+        char *buf = static_cast<char *>(
+            std::aligned_alloc(FileManager::IO_ALIGNMENT, pages * FileManager::PAGE_SIZE));
+        if (!buf) throw std::bad_alloc();
+        std::free(s.buf);
+        s.buf = buf;
+        s.pages = pages;
+    }
+    return s.buf;
+}
+// Largest run staged in one write
+constexpr std::size_t MAX_STAGED_PAGES = 64;
+
+// Stamped at the start of a page linked into the free chain
+constexpr std::uint32_t FREE_PAGE_MAGIC = 0x45455246;  // "FREE"
+struct FreePageLink {
+    std::uint32_t magic;
+    std::int32_t  next;
+};
+
+// Stands in for reserved pages that were never written (beyond EOF,
+// where touching a mapping would fault)
+alignas(FileManager::IO_ALIGNMENT) const char ZERO_PAGE[FileManager::PAGE_SIZE] = {};
+
+} // namespace
+
+FileManager::FileEntry::~FileEntry() {
+    unmapAll();
+    compressed.reset();
+    if (fd >= 0) ::close(fd);
+}
+
+void FileManager::FileEntry::unmapAll() {
+    for (auto &m : maps) ::munmap(m.addr, m.reserved);
+    maps.clear();
+}
+
+FileManager::FileManager(IOMode mode) : mode_(mode) {}
+
+FileManager::~FileManager() {
+    std::unique_lock<std::shared_mutex> guard(tableLatch_);
+    for (auto &kv : files_) {
+        FileEntry &e = *kv.second;
+        try {
+            if (e.compressed) {
+                // The page map must not reference blobs still in flight
+                sync(e);
+            } else {
+                std::lock_guard<std::mutex> alloc(e.allocLatch);
+                if (e.headerDirty) writeHeader(e);
+            }
+        } catch (...) {}
+    }
+    files_.clear();
+}
+
+int FileManager::openFile(const std::string &filePath, PageCompression compression) {
+    // Opens an existing file or creates it
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+    bool direct = false;
+    int fd = -1;
+    if (mode_ == IOMode::DIRECT) {
+        fd = ::open(filePath.c_str(), flags | O_DIRECT, 0644);
+        direct = fd >= 0;
+        // Filesystems without O_DIRECT support fall back to buffered I/O
+        if (fd < 0 && errno != EINVAL) {
+            throw ioError("Failed to create file: " + filePath);
+        }
+    }
+    if (fd < 0) fd = ::open(filePath.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw ioError("Failed to create file: " + filePath);
     }
+    auto entry = std::make_shared<FileEntry>();
+    entry->fd = fd;
+    entry->path = filePath;
+    entry->direct = direct;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) throw ioError("fstat failed: " + filePath);
+    entry->dev = st.st_dev;
+    entry->ino = st.st_ino;
+    // The copy can be long: do it before taking the table latch, so that
+    // lookups on every other open file do not wait for it
+    off_t legacyPages = legacyPageCount(*entry, st);
+    if (legacyPages >= 0) convertLegacy(*entry, legacyPages);
 
+    std::unique_lock<std::shared_mutex> guard(tableLatch_);
+    // The same file opened twice must share one cached header
+    for (auto &kv : files_) {
+        if (kv.second->dev == entry->dev && kv.second->ino == entry->ino) {
+            kv.second->refs++;
+            return kv.first;  // entry's destructor closes the extra fd
+        }
+    }
+    loadHeader(*entry, compression);
+    int fid = nextFileId_++;
     files_.emplace(fid, std::move(entry));
     return fid;
 }
 
 void FileManager::closeFile(int fileId) {
-    auto it = files_.find(fileId);
-    if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    it->second.stream.close();
-    files_.erase(it);
+    std::shared_ptr<FileEntry> entry;
+    {
+        std::unique_lock<std::shared_mutex> guard(tableLatch_);
+        auto it = files_.find(fileId);
+        if (it == files_.end()) throw std::runtime_error("Invalid fileId");
+        if (--it->second->refs > 0) return;
+        entry = std::move(it->second);
+        files_.erase(it);
+    }
+    if (entry->compressed) {
+        sync(*entry);
+    } else {
+        std::lock_guard<std::mutex> alloc(entry->allocLatch);
+        if (entry->headerDirty) writeHeader(*entry);
+    }
+    // fd is closed once the last in-flight user drops its reference
 }
 
-void FileManager::readPage(int fileId, int pageId, char *buffer) {
+std::shared_ptr<FileManager::FileEntry> FileManager::getEntry(int fileId) const {
+    std::shared_lock<std::shared_mutex> guard(tableLatch_);
     auto it = files_.find(fileId);
     if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    FileEntry &e = it->second;
+    return it->second;
+}
+
+std::string FileManager::filePath(int fileId) const {
+    return getEntry(fileId)->path;
+}
+
+std::uint32_t FileManager::formatTag(int fileId) const {
+    auto e = getEntry(fileId);
+    std::lock_guard<std::mutex> guard(e->allocLatch);
+    return e->formatTag;
+}
+
+void FileManager::setFormatTag(int fileId, std::uint32_t tag) {
+    auto e = getEntry(fileId);
+    std::lock_guard<std::mutex> guard(e->allocLatch);
+    if (e->formatTag == tag) return;
+    e->formatTag = tag;
+    writeHeader(*e);
+}
+
+std::size_t FileManager::usablePageSize(int fileId) const {
+    return getEntry(fileId)->checksums ? USABLE_PAGE_SIZE : PAGE_SIZE;
+}
+
+int FileManager::findFile(const std::string &filePath) const {
+    struct stat st;
+    if (::stat(filePath.c_str(), &st) != 0) return -1;
+    std::shared_lock<std::shared_mutex> guard(tableLatch_);
+    for (auto &kv : files_) {
+        if (kv.second->dev == st.st_dev && kv.second->ino == st.st_ino) return kv.first;
+    }
+    return -1;
+}
+
+void FileManager::loadHeader(FileEntry &e, PageCompression compression) {
+    struct stat st;
+    if (::fstat(e.fd, &st) != 0) throw ioError("fstat failed: " + e.path);
+    if (st.st_size == 0) {
+        // Fresh file: lay down an empty header
+        e.pageCount = 0;
+        e.freeHead = -1;
+        e.freeCount = 0;
+        e.checksums = true;
+        if (compression == PageCompression::LZ) openCompressed(e);
+        writeHeader(e);
+        return;
+    }
+
+    char *page = bouncePage();
+    std::size_t got = preadFull(e.fd, page, PAGE_SIZE, 0);
+    FileHeader hdr;
+    std::memcpy(&hdr, page, sizeof(hdr));
+    if (got < sizeof(hdr) || hdr.magic != HEADER_MAGIC) {
+        throw std::runtime_error("Missing file header: " + e.path);
+    }
+    if (hdr.version != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported file format version: " + e.path);
+    }
+    // The count is only persisted on close/sync; after a crash the file
+    // may have grown past it, so trust whichever is larger.
+    off_t pagesOnDisk;
+    if (hdr.flags & FLAG_COMPRESSED) {
+        openCompressed(e);
+        pagesOnDisk = e.compressed->mappedPages();
+    } else {
+        pagesOnDisk = (st.st_size + static_cast<off_t>(PAGE_SIZE) - 1) /
+                      static_cast<off_t>(PAGE_SIZE) - 1;
+    }
+    e.pageCount = std::max<int>(hdr.pageCount, static_cast<int>(pagesOnDisk));
+    e.freeHead = hdr.freeHead;
+    e.freeCount = hdr.freeCount;
+    e.checksums = (hdr.flags & FLAG_CHECKSUMS) != 0;
+    e.formatTag = hdr.formatTag;
+    e.headerDirty = e.pageCount.load() != hdr.pageCount;
+}
+
+off_t FileManager::legacyPageCount(FileEntry &e, const struct stat &st) {
+    // Files from before the header page are whole raw pages, no magic
+    if (st.st_size == 0 || st.st_size % static_cast<off_t>(PAGE_SIZE) != 0) return -1;
+    char *page = bouncePage();
+    FileHeader hdr;
+    if (preadFull(e.fd, page, PAGE_SIZE, 0) < sizeof(hdr)) return -1;
+    std::memcpy(&hdr, page, sizeof(hdr));
+    if (hdr.magic == HEADER_MAGIC) return -1;
+    return st.st_size / static_cast<off_t>(PAGE_SIZE);
+}
+
+void FileManager::convertLegacy(FileEntry &e, off_t pages) {
+    // One conversion per file at a time; keyed by inode so every path to
+    // the file shares the latch
+    std::string key = std::to_string(e.dev) + ":" + std::to_string(e.ino);
+    std::shared_ptr<std::mutex> latch;
+    {
+        std::lock_guard<std::mutex> guard(convertLatch_);
+        auto &slot = converting_[key];
+        if (!slot) slot = std::make_shared<std::mutex>();
+        latch = slot;
+    }
+    try {
+        std::lock_guard<std::mutex> guard(*latch);
+        struct stat st;
+        if (::stat(e.path.c_str(), &st) != 0) throw ioError("stat failed: " + e.path);
+        if (st.st_dev == e.dev && st.st_ino == e.ino) {
+            copyLegacy(e, pages);
+        }
+        // Converted by us or by a concurrent opener: switch to the result
+        reopen(e);
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(convertLatch_);
+        if (latch.use_count() == 2) converting_.erase(key);
+        throw;
+    }
+    std::lock_guard<std::mutex> guard(convertLatch_);
+    if (latch.use_count() == 2) converting_.erase(key);
+}
+
+void FileManager::copyLegacy(FileEntry &e, off_t pages) {
+    // Legacy pages fill all PAGE_SIZE bytes and carry no trailer, and the
+    // free list only ever lived in memory
+    constexpr off_t COPY_PAGES = 64;
+    std::string tmp = e.path + ".migrate";
+    int flags = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC | (e.direct ? O_DIRECT : 0);
+    int fd = ::open(tmp.c_str(), flags, 0644);
+    if (fd < 0) throw ioError("Failed to create file: " + tmp);
+    char *buf = static_cast<char *>(std::aligned_alloc(IO_ALIGNMENT, COPY_PAGES * PAGE_SIZE));
+    try {
+        if (!buf) throw std::bad_alloc();
+        std::memset(buf, 0, PAGE_SIZE);
+        FileHeader hdr{HEADER_MAGIC, FORMAT_VERSION, static_cast<std::int32_t>(pages),
+                       -1, 0, 0u, 0u};
+        std::memcpy(buf, &hdr, sizeof(hdr));
+        pwriteFull(fd, buf, PAGE_SIZE, 0);
+        for (off_t p = 0; p < pages; p += COPY_PAGES) {
+            std::size_t len = std::min(COPY_PAGES, pages - p) * PAGE_SIZE;
+            if (preadFull(e.fd, buf, len, p * PAGE_SIZE) != len)
+                throw std::runtime_error("File shrank while converting: " + e.path);
+            pwriteFull(fd, buf, len, (p + 1) * PAGE_SIZE);
+        }
+        // The copy must be on disk before it replaces the original
+        if (::fsync(fd) != 0) throw ioError("fsync failed: " + tmp);
+        if (std::rename(tmp.c_str(), e.path.c_str()) != 0)
+            throw ioError("Failed to replace file: " + e.path);
+    } catch (...) {
+        std::free(buf);
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+    std::free(buf);
+    ::close(fd);
+    std::string dir = e.path.substr(0, e.path.find_last_of('/') + 1);
+    int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+void FileManager::reopen(FileEntry &e) {
+    int fd = ::open(e.path.c_str(), O_RDWR | O_CLOEXEC | (e.direct ? O_DIRECT : 0));
+    if (fd < 0) throw ioError("Failed to reopen file: " + e.path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw ioError("fstat failed: " + e.path);
+    }
+    ::close(e.fd);
+    e.fd = fd;
+    e.dev = st.st_dev;
+    e.ino = st.st_ino;
+}
+
+void FileManager::writeHeader(FileEntry &e) {
+    char *page = bouncePage();
+    std::memset(page, 0, PAGE_SIZE);
+    FileHeader hdr{HEADER_MAGIC, FORMAT_VERSION, e.pageCount.load(),
+                   e.freeHead, e.freeCount,
+                   (e.compressed ? FLAG_COMPRESSED : 0u) |
+                   (e.checksums ? FLAG_CHECKSUMS : 0u),
+                   e.formatTag};
+    std::memcpy(page, &hdr, sizeof(hdr));
+    pwriteFull(e.fd, page, PAGE_SIZE, 0);
+    e.headerDirty = false;
+}
 
-    int totalPages = getPageCount(fileId);
-    if (pageId < 0 || pageId >= totalPages) {
+void FileManager::openCompressed(FileEntry &e) {
+    if (e.direct) {
+        // Blobs are sector-sized, not page-aligned: go through the page cache
+        int fd = ::open(e.path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) throw ioError("Failed to reopen file: " + e.path);
+        ::close(e.fd);
+        e.fd = fd;
+        e.direct = false;
+    }
+    e.compressed = std::make_unique<CompressedPageStore>(
+        e.fd, static_cast<off_t>(PAGE_SIZE), e.path + ".pmap");
+}
+
+void FileManager::readPhysical(FileEntry &e, int pageId, char *page) {
+    if (e.compressed) {
+        e.compressed->readPage(pageId, page);
+    } else {
+        std::size_t got = preadFull(e.fd, page, PAGE_SIZE, pageOffset(pageId));
+        std::fill(page + got, page + PAGE_SIZE, 0);
+    }
+    verifyPage(e, pageId, page);
+}
+
+void FileManager::writePhysical(FileEntry &e, int pageId, char *page) {
+    if (e.checksums) stampTrailer(page, pageId);
+    if (e.compressed) {
+        e.compressed->writePage(pageId, page);
+        return;
+    }
+    pwriteFull(e.fd, page, PAGE_SIZE, pageOffset(pageId));
+}
+
+void FileManager::stampTrailer(char *page, int pageId) {
+    PageTrailer t = makeTrailer(page, pageId);
+    std::memcpy(page + USABLE_PAGE_SIZE, &t, sizeof(t));
+}
+
+bool FileManager::trailerValid(const char *page, int pageId) {
+    PageTrailer want = makeTrailer(page, pageId);
+    PageTrailer have;
+    std::memcpy(&have, page + USABLE_PAGE_SIZE, sizeof(have));
+    if (have.checksum == want.checksum && have.pageId == pageId) return true;
+    // Reserved pages that were never written read back as all zeros
+    return std::all_of(page, page + PAGE_SIZE, [](char c) { return c == 0; });
+}
+
+void FileManager::verifyPage(const FileEntry &e, int pageId, const char *page) {
+    if (e.checksums && !trailerValid(page, pageId)) {
+        throw PageChecksumError("Checksum mismatch (torn or corrupt page) at page " +
+                                 std::to_string(pageId) + " of " + e.path);
+    }
+}
+
+void FileManager::readPage(int fileId, int pageId, char *buffer) {
+    auto e = getEntry(fileId);
+    if (pageId < 0 || pageId >= e->pageCount.load(std::memory_order_acquire)) {
         // Out-of-bounds: return zeroed page
         std::fill(buffer, buffer + PAGE_SIZE, 0);
         return;
     }
+    if (e->compressed) {
+        e->compressed->readPage(pageId, buffer);
+        verifyPage(*e, pageId, buffer);
+        return;
+    }
 
-    std::streampos offset = static_cast<std::streampos>(pageId) * PAGE_SIZE;
-    e.stream.seekg(offset, std::ios::beg);
-    e.stream.read(buffer, PAGE_SIZE);
-    if (e.stream.gcount() < static_cast<std::streamsize>(PAGE_SIZE)) {
-        // Partial read: zero the rest
-        std::fill(buffer + e.stream.gcount(), buffer + PAGE_SIZE, 0);
+    char *dst = (e->direct && !isAligned(buffer)) ? bouncePage() : buffer;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t got = preadFull(e->fd, dst, PAGE_SIZE, pageOffset(pageId));
+    if (!e->direct) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        noteRead(*e, pageId, static_cast<long>(us));
+    }
+    if (dst != buffer) std::memcpy(buffer, dst, got);
+    if (got < PAGE_SIZE) {
+        // Past end of file or partial page: zero the rest
+        std::fill(buffer + got, buffer + PAGE_SIZE, 0);
+    }
+    verifyPage(*e, pageId, buffer);
+}
+
+void FileManager::readPages(int fileId, int firstPageId, char *const *buffers, int count) {
+    auto e = getEntry(fileId);
+    bool gather = !e->compressed && firstPageId >= 0;
+    for (int i = 0; gather && e->direct && i < count; ++i) gather = isAligned(buffers[i]);
+    if (!gather) {
+        for (int i = 0; i < count; ++i) readPage(fileId, firstPageId + i, buffers[i]);
+        return;
+    }
+    // Pages past the end read as zeros, like readPage
+    int inFile = std::max(0, std::min(count, e->pageCount.load(std::memory_order_acquire) -
+                                             firstPageId));
+    for (int i = inFile; i < count; ++i) std::fill(buffers[i], buffers[i] + PAGE_SIZE, 0);
+
+    long iovMax = ::sysconf(_SC_IOV_MAX);
+    int maxRun = iovMax > 0 ? static_cast<int>(iovMax) : 16;
+    std::vector<struct iovec> iov;
+    for (int run = 0; run < inFile; run += maxRun) {
+        int n = std::min(maxRun, inFile - run);
+        iov.clear();
+        for (int i = run; i < run + n; ++i) iov.push_back({buffers[i], PAGE_SIZE});
+        std::size_t got = preadvFull(e->fd, iov, pageOffset(firstPageId + run));
+        for (int i = run; i < run + n; ++i) {
+            std::size_t start = static_cast<std::size_t>(i - run) * PAGE_SIZE;
+            if (got < start + PAGE_SIZE) {
+                std::size_t have = got > start ? got - start : 0;
+                std::fill(buffers[i] + have, buffers[i] + PAGE_SIZE, 0);
+            }
+            verifyPage(*e, firstPageId + i, buffers[i]);
+        }
     }
 }
 
 void FileManager::writePage(int fileId, int pageId, const char *buffer) {
-    auto it = files_.find(fileId);
-    if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    FileEntry &e = it->second;
+    auto e = getEntry(fileId);
+    if (pageId < 0) throw std::runtime_error("Invalid pageId");
 
-    std::streampos offset = static_cast<std::streampos>(pageId) * PAGE_SIZE;
-    e.stream.seekp(offset, std::ios::beg);
-    e.stream.write(buffer, PAGE_SIZE);
-    e.stream.flush();
+    if (e->compressed || (e->direct && (e->checksums || !isAligned(buffer)))) {
+        // Stage the page in an aligned copy we are allowed to stamp
+        char *bounce = bouncePage();
+        std::memcpy(bounce, buffer, e->checksums ? USABLE_PAGE_SIZE : PAGE_SIZE);
+        writePhysical(*e, pageId, bounce);
+    } else if (e->checksums) {
+        // Gather the trailer from the stack; the caller's page stays untouched
+        PageTrailer t = makeTrailer(buffer, pageId);
+        std::vector<struct iovec> iov{{const_cast<char *>(buffer), USABLE_PAGE_SIZE},
+                                      {&t, sizeof(t)}};
+        pwritevFull(e->fd, iov, pageOffset(pageId));
+    } else {
+        pwriteFull(e->fd, buffer, PAGE_SIZE, pageOffset(pageId));
+    }
+    noteWritten(*e, pageId);
 }
 
-int FileManager::getPageCount(int fileId) {
-    auto it = files_.find(fileId);
-    if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    FileEntry &e = it->second;
+void FileManager::noteRead(FileEntry &e, int pageId, long micros) {
+    // A read slower than this went to the device: readahead is not far
+    // enough ahead of the reader for the throughput it is getting
+    constexpr long DEVICE_READ_US = 50;
+
+    std::lock_guard<std::mutex> guard(e.raLatch);
+    if (e.pattern == AccessPattern::RANDOM) return;
+    if (pageId == e.lastRead + 1) {
+        e.seqRun++;
+        if (micros > DEVICE_READ_US)
+            e.raWindow = std::min(e.raWindow * 2, MAX_READAHEAD_PAGES);
+    } else {
+        e.seqRun = 0;
+        e.raWindow = MIN_READAHEAD_PAGES;
+        e.raIssuedUntil = 0;
+    }
+    e.lastRead = pageId;
+
+    bool sequential = e.pattern == AccessPattern::SEQUENTIAL || e.seqRun >= 2;
+    // Issue the next window once the reader is halfway through the last one
+    if (!sequential || pageId + e.raWindow / 2 < e.raIssuedUntil) return;
+    int from = std::max(pageId + 1, e.raIssuedUntil);
+    int to = std::min(pageId + 1 + e.raWindow, e.pageCount.load());
+    if (from >= to) return;
+    ::posix_fadvise(e.fd, pageOffset(from),
+                    static_cast<off_t>(to - from) * PAGE_SIZE,
+                    POSIX_FADV_WILLNEED);
+    e.raIssuedUntil = to;
+}
+
+void FileManager::adviseAccess(int fileId, AccessPattern pattern) {
+    auto e = getEntry(fileId);
+    // Compressed blobs do not sit at their logical offsets
+    if (e->direct || e->compressed) return;
+    std::lock_guard<std::mutex> guard(e->raLatch);
+    setPattern(*e, pattern);
+}
+
+void FileManager::beginSequentialScan(int fileId) {
+    auto e = getEntry(fileId);
+    if (e->direct || e->compressed) return;
+    std::lock_guard<std::mutex> guard(e->raLatch);
+    if (e->sequentialScans++ == 0) setPattern(*e, AccessPattern::SEQUENTIAL);
+}
+
+void FileManager::endSequentialScan(int fileId) {
+    auto e = getEntry(fileId);
+    if (e->direct || e->compressed) return;
+    std::lock_guard<std::mutex> guard(e->raLatch);
+    if (e->sequentialScans > 0 && --e->sequentialScans == 0)
+        setPattern(*e, AccessPattern::NORMAL);
+}
+
+void FileManager::setPattern(FileEntry &e, AccessPattern pattern) {
+    int advice = pattern == AccessPattern::SEQUENTIAL ? POSIX_FADV_SEQUENTIAL
+               : pattern == AccessPattern::RANDOM     ? POSIX_FADV_RANDOM
+                                                      : POSIX_FADV_NORMAL;
+    ::posix_fadvise(e.fd, 0, 0, advice);
+    e.pattern = pattern;
+    e.seqRun = 0;
+    e.raWindow = MIN_READAHEAD_PAGES;
+    e.raIssuedUntil = 0;
+}
+
+void FileManager::noteWritten(FileEntry &e, int lastPageId) {
+    if (lastPageId >= e.pageCount.load(std::memory_order_acquire)) {
+        // Writing past the end implicitly grows the file
+        std::lock_guard<std::mutex> guard(e.allocLatch);
+        if (lastPageId >= e.pageCount.load()) {
+            e.pageCount.store(lastPageId + 1, std::memory_order_release);
+            e.headerDirty = true;
+        }
+    }
+}
+
+void FileManager::writePages(std::vector<PageWrite> pages) {
+    std::sort(pages.begin(), pages.end(),
+              [](const PageWrite &a, const PageWrite &b) {
+                  return a.fileId != b.fileId ? a.fileId < b.fileId
+                                              : a.pageId < b.pageId;
+              });
+    long iovMax = ::sysconf(_SC_IOV_MAX);
+    std::size_t maxRun = iovMax > 0 ? static_cast<std::size_t>(iovMax) : 16;
 
-    std::streampos current = e.stream.tellg();
-    e.stream.seekg(0, std::ios::end);
-    std::streampos fileSize = e.stream.tellg();
-    e.stream.seekg(current);
+    std::vector<struct iovec> iov;
+    std::vector<PageTrailer> trailers;
+    trailers.reserve(maxRun);
+    std::size_t i = 0;
+    while (i < pages.size()) {
+        auto e = getEntry(pages[i].fileId);
+        std::size_t end = i;
+        while (end < pages.size() && pages[end].fileId == pages[i].fileId) ++end;
 
-    return static_cast<int>(fileSize / PAGE_SIZE);
+        // Coalesce runs of consecutive pages within this file
+        std::size_t run = i;
+        if (e->compressed) {
+            // Every page is compressed separately; there is nothing to gather
+            for (; run < end; ++run) {
+                writePage(pages[run].fileId, pages[run].pageId, pages[run].data);
+            }
+        }
+        while (run < end) {
+            const PageWrite &first = pages[run];
+            if (first.pageId < 0) throw std::runtime_error("Invalid pageId");
+            std::size_t j = run;
+            auto adjacent = [&](std::size_t k) {
+                return pages[k].pageId == first.pageId + static_cast<int>(k - run);
+            };
+            if (e->direct && e->checksums) {
+                // Direct I/O cannot gather a trailer from outside the page:
+                // copy the run into an aligned staging buffer and stamp there
+                while (j < end && j - run < MAX_STAGED_PAGES && adjacent(j)) ++j;
+                char *stage = stagingBuffer(j - run);
+                for (std::size_t k = run; k < j; ++k) {
+                    char *dst = stage + (k - run) * PAGE_SIZE;
+                    std::memcpy(dst, pages[k].data, USABLE_PAGE_SIZE);
+                    stampTrailer(dst, pages[k].pageId);
+                }
+                pwriteFull(e->fd, stage, (j - run) * PAGE_SIZE, pageOffset(first.pageId));
+                noteWritten(*e, pages[j - 1].pageId);
+                run = j;
+                continue;
+            }
+            iov.clear();
+            trailers.clear();
+            while (j < end && iov.size() + 2 <= maxRun && adjacent(j)) {
+                // Direct I/O cannot gather from unaligned buffers
+                if (e->direct && !isAligned(pages[j].data)) break;
+                if (e->checksums) {
+                    trailers.push_back(makeTrailer(pages[j].data, pages[j].pageId));
+                    iov.push_back({const_cast<char *>(pages[j].data), USABLE_PAGE_SIZE});
+                    iov.push_back({&trailers.back(), sizeof(PageTrailer)});
+                } else {
+                    iov.push_back({const_cast<char *>(pages[j].data), PAGE_SIZE});
+                }
+                ++j;
+            }
+            if (iov.empty()) {
+                writePage(first.fileId, first.pageId, first.data);
+                ++run;
+                continue;
+            }
+            pwritevFull(e->fd, iov, pageOffset(first.pageId));
+            noteWritten(*e, pages[j - 1].pageId);
+            run = j;
+        }
+        i = end;
+    }
+}
+
+void FileManager::sync(FileEntry &e) {
+    {
+        std::lock_guard<std::mutex> guard(e.allocLatch);
+        if (e.headerDirty) writeHeader(e);
+    }
+    while (::fdatasync(e.fd) != 0) {
+        if (errno != EINTR) throw ioError("fdatasync failed: " + e.path);
+    }
+    // Only now may the page map point at the blobs just written
+    if (e.compressed) e.compressed->sync();
+}
+
+void FileManager::syncFile(int fileId) {
+    sync(*getEntry(fileId));
+}
+
+void FileManager::syncAll() {
+    std::vector<std::shared_ptr<FileEntry>> open;
+    {
+        std::shared_lock<std::shared_mutex> guard(tableLatch_);
+        for (auto &kv : files_) open.push_back(kv.second);
+    }
+    for (auto &e : open) sync(*e);
+}
+
+int FileManager::getPageCount(int fileId) const {
+    return getEntry(fileId)->pageCount.load(std::memory_order_acquire);
 }
 
 int FileManager::allocatePage(int fileId) {
-    auto it = files_.find(fileId);
-    if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    FileEntry &e = it->second;
+    auto e = getEntry(fileId);
+    std::lock_guard<std::mutex> guard(e->allocLatch);
 
-    if (!e.freeList.empty()) {
-        int pid = e.freeList.back();
-        e.freeList.pop_back();
+    if (e->freeHead >= 0) {
+        // Pop the head of the on-disk free chain
+        int pid = e->freeHead;
+        char *page = bouncePage();
+        readPhysical(*e, pid, page);
+        FreePageLink link;
+        std::memcpy(&link, page, sizeof(link));
+        if (link.magic != FREE_PAGE_MAGIC) {
+            throw std::runtime_error("Corrupt free-page chain in " + e->path);
+        }
+        e->freeHead = link.next;
+        e->freeCount--;
+        // Hand the page out zeroed, like a fresh one
+        std::memset(page, 0, PAGE_SIZE);
+        writePhysical(*e, pid, page);
+        // Persist the new head now so a crash cannot hand this page out twice
+        writeHeader(*e);
         return pid;
     }
-    int newPage = getPageCount(fileId);
-    // Initialize new page to zeros
-    std::vector<char> zeros(PAGE_SIZE, 0);
-    writePage(fileId, newPage, zeros.data());
+    int newPage = e->pageCount.load();
+    if (newPage >= e->extentEnd && !e->compressed) {
+        // Reserve the next extent. KEEP_SIZE leaves EOF alone, so the page
+        // count reconciled on open only covers pages actually written; reads
+        // of reserved-but-unwritten pages come back zeroed.
+        int extent = std::max(1, e->extentPages);
+#ifdef FALLOC_FL_KEEP_SIZE
+        if (::fallocate(e->fd, FALLOC_FL_KEEP_SIZE, pageOffset(newPage),
+                        static_cast<off_t>(extent) * PAGE_SIZE) != 0 &&
+            errno != EOPNOTSUPP && errno != ENOSYS) {
+            throw ioError("fallocate failed: " + e->path);
+        }
+#endif
+        e->extentEnd = newPage + extent;
+    }
+    e->pageCount.store(newPage + 1, std::memory_order_release);
+    e->headerDirty = true;
     return newPage;
 }
 
+void FileManager::setExtentSize(int fileId, int pages) {
+    if (pages <= 0) throw std::runtime_error("Extent size must be positive");
+    auto e = getEntry(fileId);
+    std::lock_guard<std::mutex> guard(e->allocLatch);
+    e->extentPages = pages;
+}
+
 void FileManager::deallocatePage(int fileId, int pageId) {
-    auto it = files_.find(fileId);
-    if (it == files_.end()) throw std::runtime_error("Invalid fileId");
-    if (pageId < 0) throw std::runtime_error("Invalid pageId");
-    it->second.freeList.push_back(pageId);
-}
\ No newline at end of file
+    auto e = getEntry(fileId);
+    std::lock_guard<std::mutex> guard(e->allocLatch);
+    if (pageId < 0 || pageId >= e->pageCount.load()) {
+        throw std::runtime_error("Invalid pageId");
+    }
+    char *page = bouncePage();
+    std::memset(page, 0, PAGE_SIZE);
+    FreePageLink link{FREE_PAGE_MAGIC, e->freeHead};
+    std::memcpy(page, &link, sizeof(link));
+    writePhysical(*e, pageId, page);
+    e->freeHead = pageId;
+    e->freeCount++;
+    writeHeader(*e);
+}
+
+const char *FileManager::mapPage(int fileId, int pageId) {
+    auto e = getEntry(fileId);
+    if (e->compressed) {
+        throw std::runtime_error("Cannot map a compressed file: " + e->path);
+    }
+    if (pageId < 0 || pageId >= e->pageCount.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::size_t begin = static_cast<std::size_t>(pageOffset(pageId));
+    std::size_t end = begin + PAGE_SIZE;
+    {
+        std::shared_lock<std::shared_mutex> guard(e->mapLatch);
+        if (!e->maps.empty() && end <= e->maps.back().len) {
+            return e->maps.back().addr + begin;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> guard(e->mapLatch);
+    if (e->maps.empty() || end > e->maps.back().len) {
+        struct stat st;
+        if (::fstat(e->fd, &st) != 0) throw ioError("fstat failed: " + e->path);
+        // Whole pages only, so each growth maps at a page-aligned offset
+        std::size_t size = static_cast<std::size_t>(st.st_size) / PAGE_SIZE * PAGE_SIZE;
+        if (end > size) return ZERO_PAGE;
+        if (e->maps.empty() || size > e->maps.back().reserved) {
+            // Inaccessible and uncommitted until the file is mapped over it
+            std::size_t reserved = std::max(MIN_MAP_RESERVE, 2 * size);
+            void *addr = ::mmap(nullptr, reserved, PROT_NONE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (addr == MAP_FAILED) throw ioError("mmap failed: " + e->path);
+            e->maps.push_back({static_cast<char *>(addr), 0, reserved});
+        }
+        // Map only the new tail; the kernel merges it with the mapping
+        // before it, so growth does not add mappings
+        auto &m = e->maps.back();
+        void *addr = ::mmap(m.addr + m.len, size - m.len, PROT_READ,
+                            MAP_SHARED | MAP_FIXED, e->fd, static_cast<off_t>(m.len));
+        if (addr == MAP_FAILED) throw ioError("mmap failed: " + e->path);
+        m.len = size;
+    }
+    return e->maps.back().addr + begin;
+}
+
+void FileManager::unmapFile(int fileId) {
+    auto e = getEntry(fileId);
+    std::unique_lock<std::shared_mutex> guard(e->mapLatch);
+    e->unmapAll();
+}
+
+bool FileManager::isCompressed(int fileId) const {
+    return getEntry(fileId)->compressed != nullptr;
+}
@@ -4,39 +4,276 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <fstream>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
 #include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+class CompressedPageStore;
+
+// Page-oriented file I/O on raw file descriptors. All page reads and writes
+// are positional (pread/pwrite), so any number of threads may do I/O on the
+// same file concurrently; the file table itself is guarded by a reader/writer
+// latch so lookups never serialize against each other.
+//
+// In IOMode::DIRECT files are opened with O_DIRECT so pages bypass the kernel
+// page cache and are cached only once, in the buffer pool. Direct transfers
+// must use IO_ALIGNMENT-aligned buffers; unaligned callers are served through
+// an aligned bounce buffer, so the API is the same in both modes.
+//
+// Every file starts with a header page holding the page count and the head
+// of an on-disk chain of freed pages; page ids handed to callers are logical
+// and start at 0 after the header. The count is cached in memory so
+// getPageCount/allocatePage never touch the disk. A file written before the
+// header existed (raw pages, no magic) is converted when first opened: its
+// pages are copied behind a new header into a temporary file that then
+// replaces it.
+//
+// Writes are not durable on their own: writePage/writePages only hand the
+// data to the kernel. syncFile/syncAll are the durability barriers.
+//
+// The last PAGE_TRAILER_SIZE bytes of every page belong to FileManager: each
+// write stamps a CRC-32C of the first USABLE_PAGE_SIZE bytes there and each
+// read verifies it, so a torn or corrupted page is reported (by throwing)
+// instead of being handed to the caller. Callers must keep their data within
+// USABLE_PAGE_SIZE. Files created before checksums existed are not checked.
+//
+// A file may be created with PageCompression::LZ: pages are then compressed
+// on their way to disk and decompressed on read (see CompressedPageStore),
+// so callers and the buffer pool only ever see full uncompressed pages.
+// The choice is recorded in the header and sticks for the file's lifetime.
+// Compressed files are always buffered and cannot be memory-mapped.
+enum class IOMode { BUFFERED, DIRECT };
+
+// On-disk page format of a file
+enum class PageCompression { NONE, LZ };
+
+// Access-pattern hints for readahead
+enum class AccessPattern { NORMAL, SEQUENTIAL, RANDOM };
+
+// Thrown when a page read back fails its checksum (torn or corrupt page)
+class PageChecksumError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// One page of a bulk write; `data` holds PAGE_SIZE bytes
+struct PageWrite {
+    int fileId;
+    int pageId;
+    const char *data;
+};
 
 class FileManager {
 public:
     static constexpr std::size_t PAGE_SIZE = 8192;
+    // Checksum trailer at the end of each page, and the space left for data
+    static constexpr std::size_t PAGE_TRAILER_SIZE = 8;
+    static constexpr std::size_t USABLE_PAGE_SIZE = PAGE_SIZE - PAGE_TRAILER_SIZE;
+    // Buffer/offset alignment required for direct I/O
+    static constexpr std::size_t IO_ALIGNMENT = 4096;
+    // Pages reserved on disk each time a file grows, unless overridden
+    static constexpr int DEFAULT_EXTENT_PAGES = 64;
+    // Readahead window bounds, in pages
+    static constexpr int MIN_READAHEAD_PAGES = 8;
+    static constexpr int MAX_READAHEAD_PAGES = 256;
+    // Smallest address range reserved for a file's mapping
+    static constexpr std::size_t MIN_MAP_RESERVE = std::size_t(1) << 30;
+
+    explicit FileManager(IOMode mode = IOMode::BUFFERED);
+    ~FileManager();
+    FileManager(const FileManager &) = delete;
+    FileManager &operator=(const FileManager &) = delete;
 
     // Opens an existing file or creates a new one. Returns an integer file handle.
-    int openFile(const std::string &filePath);
-    // Closes the file associated with the given handle.
+    // Opening a file that is already open returns the same handle.
+    // `compression` only applies when the file is created; an existing file
+    // keeps the format recorded in its header.
+    int openFile(const std::string &filePath,
+                 PageCompression compression = PageCompression::NONE);
+    // Closes the file associated with the given handle (once every openFile
+    // of it has been matched by a closeFile), persisting its header.
     void closeFile(int fileId);
+    // Path the file was first opened under
+    std::string filePath(int fileId) const;
+    // Handle of an already open file at filePath (same inode), or -1
+    int findFile(const std::string &filePath) const;
+    // Owner-defined format id kept in the header (e.g. a table's page
+    // layout); 0 for files that never set one. Setting it rewrites the
+    // header straight away.
+    std::uint32_t formatTag(int fileId) const;
+    void setFormatTag(int fileId, std::uint32_t tag);
+    // Bytes of each page the caller may use: USABLE_PAGE_SIZE, or all of
+    // PAGE_SIZE for a file without checksums (e.g. a converted legacy file)
+    std::size_t usablePageSize(int fileId) const;
 
     // Reads a full page (PAGE_SIZE bytes) at pageId into the provided buffer.
-    // If pageId >= current page count, buffer is zeroed.
+    // If pageId >= current page count, buffer is zeroed. Throws if the page
+    // fails its checksum.
     void readPage(int fileId, int pageId, char *buffer);
-    // Writes a full page (PAGE_SIZE bytes) from the provided buffer into pageId.
+    // Reads count consecutive pages starting at firstPageId, page i into
+    // buffers[i], with as few preadv calls as IOV_MAX allows. Same zeroing
+    // and checksum rules as readPage. Compressed files (and unaligned
+    // buffers on O_DIRECT files) fall back to one readPage per page.
+    void readPages(int fileId, int firstPageId, char *const *buffers, int count);
+    // Writes a page from the provided buffer into pageId. The buffer holds
+    // PAGE_SIZE bytes; its trailer bytes are ignored and written as the checksum.
     void writePage(int fileId, int pageId, const char *buffer);
+    // Writes many pages at once: sorts them by (file, page), coalesces runs
+    // of adjacent pages and issues each run as a single pwritev.
+    void writePages(std::vector<PageWrite> pages);
+
+    // Durability barriers: persist the header and fdatasync the file(s).
+    void syncFile(int fileId);
+    void syncAll();
 
     // Allocates a new page, either by reusing a freed page or appending at end.
-    // Returns the allocated pageId.
+    // Appends are handed out from a preallocated extent, so they cost no I/O
+    // until the extent runs out. Returns the allocated pageId.
     int allocatePage(int fileId);
-    // Marks a pageId as free for future reuse.
+    // Sets how many pages the file reserves (fallocate) each time it grows.
+    void setExtentSize(int fileId, int pages);
+    // Marks a pageId as free for future reuse. The page is linked into the
+    // on-disk free chain, so callers must drop any buffered copy of it first
+    // (BufferManager::discardPage).
     void deallocatePage(int fileId, int pageId);
 
     // Returns the total number of pages currently in the file (including those freed).
-    int getPageCount(int fileId);
+    int getPageCount(int fileId) const;
+
+    // Readahead: readPage detects sequential runs per file and asks the
+    // kernel (posix_fadvise WILLNEED) for the next window of pages ahead of
+    // the reader. The window starts small and doubles while reads still
+    // wait on the device, up to MAX_READAHEAD_PAGES. A scan can also state
+    // its pattern up front; SEQUENTIAL enables readahead from the first
+    // read, RANDOM disables it. No effect on O_DIRECT files.
+    void adviseAccess(int fileId, AccessPattern pattern);
+    // Full scans bracket themselves with these instead: the file is
+    // SEQUENTIAL while any scan of it is open and goes back to NORMAL when
+    // the last one ends, so overlapping scans do not reset each other.
+    void beginSequentialScan(int fileId);
+    void endSequentialScan(int fileId);
+
+    // Read-only memory-mapped access for cold files: returns a pointer to
+    // pageId's bytes straight from the kernel page cache, with no copy into
+    // the buffer pool, or nullptr if pageId is past the end. The mapping
+    // reflects what has been written to the file, not unflushed frames,
+    // and is not checksum-verified.
+    // Pointers stay valid until unmapFile/closeFile, even if the file grows.
+    const char *mapPage(int fileId, int pageId);
+    // Drops all mappings of the file; no pointer from mapPage may be in use.
+    void unmapFile(int fileId);
+
+    // True if the file's pages are stored compressed
+    bool isCompressed(int fileId) const;
+
+    // True if files opened by this manager bypass the OS page cache
+    bool isDirectIO() const { return mode_ == IOMode::DIRECT; }
+    // True if `buffer` can be handed to a direct read/write without bouncing
+    static bool isAligned(const void *buffer) {
+        return reinterpret_cast<std::uintptr_t>(buffer) % IO_ALIGNMENT == 0;
+    }
 
 private:
+    friend class AsyncPageIO;
+
     struct FileEntry {
-        std::fstream stream;
-        std::vector<int> freeList;
+        int fd = -1;
+        std::string path;
+        // Opened with O_DIRECT (the filesystem may refuse it, e.g. tmpfs)
+        bool direct = false;
+        // Pages carry checksum trailers (every file created since they exist)
+        bool checksums = false;
+        // Identity of the underlying inode, used to dedupe openFile calls
+        dev_t dev = 0;
+        ino_t ino = 0;
+        int refs = 1;
+        // Number of logical pages (excluding the header page)
+        std::atomic<int> pageCount{0};
+        // Serializes allocation and guards the fields below
+        std::mutex allocLatch;
+        int freeHead = -1;   // first page of the on-disk free chain
+        int freeCount = 0;
+        std::uint32_t formatTag = 0;
+        bool headerDirty = false;
+        // Appends are carved from [pageCount, extentEnd) without further I/O
+        int extentPages = DEFAULT_EXTENT_PAGES;
+        int extentEnd = 0;
+
+        // Set for compressed files; all page I/O goes through it
+        std::unique_ptr<CompressedPageStore> compressed;
+
+        // Sequential-read detector and readahead state
+        std::mutex raLatch;
+        AccessPattern pattern = AccessPattern::NORMAL;
+        int lastRead = -2;
+        int seqRun = 0;
+        int raWindow = MIN_READAHEAD_PAGES;
+        int raIssuedUntil = 0;  // pages below this were already advised
+        int sequentialScans = 0;  // open beginSequentialScan brackets
+
+        // Read-only mappings; the last one is current. Each reserves
+        // `reserved` bytes of address space and maps the file's first `len`
+        // bytes at its start, growing in place as the file grows. Only when
+        // the file outgrows the reservation is a new, twice as large one
+        // made; the old one is kept until unmap so pointers handed out stay
+        // valid, which bounds their number by the log of the file size.
+        struct Mapping { char *addr; std::size_t len; std::size_t reserved; };
+        std::shared_mutex mapLatch;
+        std::vector<Mapping> maps;
+        void unmapAll();
+
+        ~FileEntry();
     };
 
-    std::unordered_map<int, FileEntry> files_;
+    // Byte offset of a logical page within its file (page 0 follows the header)
+    static off_t pageOffset(int pageId) {
+        return static_cast<off_t>(pageId + 1) * static_cast<off_t>(PAGE_SIZE);
+    }
+
+    // Reads/creates the header on open; caller holds e.allocLatch for the rest
+    void loadHeader(FileEntry &e, PageCompression compression);
+    // Legacy (headerless) file conversion, done by openFile before the
+    // entry is published. legacyPageCount returns -1 for anything else.
+    static off_t legacyPageCount(FileEntry &e, const struct stat &st);
+    void convertLegacy(FileEntry &e, off_t pages);
+    // Writes the pages behind a header into a temporary file that then
+    // replaces the original
+    static void copyLegacy(FileEntry &e, off_t pages);
+    // Points e at whatever file is now at its path
+    static void reopen(FileEntry &e);
+    void writeHeader(FileEntry &e);
+    // Switches e to compressed storage (dropping O_DIRECT if set)
+    static void openCompressed(FileEntry &e);
+    // Whole-page transfer of an aligned page, bypassing readahead and the
+    // page-count bookkeeping; routes compressed files through their store
+    static void readPhysical(FileEntry &e, int pageId, char *page);
+    static void writePhysical(FileEntry &e, int pageId, char *page);
+    // Checksum trailer handling: stamp in place / verify a whole page
+    static void stampTrailer(char *page, int pageId);
+    static bool trailerValid(const char *page, int pageId);
+    static void verifyPage(const FileEntry &e, int pageId, const char *page);
+    // Feeds one read into the readahead detector; `micros` is its latency
+    void noteRead(FileEntry &e, int pageId, long micros);
+    // Applies an access pattern; caller holds raLatch
+    static void setPattern(FileEntry &e, AccessPattern pattern);
+    // Raises the cached page count after writing up to lastPageId
+    static void noteWritten(FileEntry &e, int lastPageId);
+    void sync(FileEntry &e);
+
+    // Looks up an open file; the returned entry stays valid even if the
+    // file is closed concurrently.
+    std::shared_ptr<FileEntry> getEntry(int fileId) const;
+
+    IOMode mode_;
+    mutable std::shared_mutex tableLatch_;
+    std::unordered_map<int, std::shared_ptr<FileEntry>> files_;
     int nextFileId_ = 1;
-};
\ No newline at end of file
+    // Legacy conversions in progress, by "dev:ino" of the original file
+    std::mutex convertLatch_;
+    std::unordered_map<std::string, std::shared_ptr<std::mutex>> converting_;
+};
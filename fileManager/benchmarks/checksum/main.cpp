@@ -0,0 +1,64 @@
+// Microbenchmark for the page checksum kernel: CRC-32C over one page's
+// usable bytes, hardware vs portable, next to the cost of copying the same
+// page (a lower bound on what a scan spends per page anyway).
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "FileManager.h"
+#include "Crc32c.h"
+
+namespace {
+
+constexpr int PAGES = 4096;     // 32 MiB working set, larger than L2
+constexpr int ROUNDS = 20;
+
+template <typename Fn>
+double nsPerPage(Fn &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (int p = 0; p < PAGES; ++p) fn(p);
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(PAGES) * ROUNDS);
+}
+
+} // namespace
+
+int main() {
+    const std::size_t pageSize = FileManager::PAGE_SIZE;
+    const std::size_t usable = FileManager::USABLE_PAGE_SIZE;
+    std::vector<char> pages(PAGES * pageSize);
+    std::mt19937 rng(42);
+    for (auto &c : pages) c = static_cast<char>(rng());
+    std::vector<char> dst(pageSize);
+
+    volatile std::uint32_t sink = 0;
+    double copy = nsPerPage([&](int p) {
+        std::memcpy(dst.data(), &pages[p * pageSize], pageSize);
+        sink = sink + static_cast<unsigned char>(dst[p % pageSize]);
+    });
+    double hw = nsPerPage([&](int p) {
+        sink = sink + Crc32c::compute(&pages[p * pageSize], usable);
+    });
+    double sw = nsPerPage([&](int p) {
+        sink = sink + Crc32c::computePortable(&pages[p * pageSize], usable);
+    });
+
+    auto row = [&](const char *name, double ns) {
+        double gbps = static_cast<double>(usable) / ns;
+        std::cout << std::left << std::setw(22) << name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(9) << ns
+                  << " ns/page " << std::setw(7) << std::setprecision(2)
+                  << gbps << " GB/s\n";
+    };
+    std::cout << "hardware crc32 available: "
+              << (Crc32c::hardwareAccelerated() ? "yes" : "no") << "\n";
+    row("memcpy (page)", copy);
+    row("crc32c compute()", hw);
+    row("crc32c portable", sw);
+    return 0;
+}
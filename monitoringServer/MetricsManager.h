@@ -16,6 +16,19 @@ public:
     void incBufferHit()   { bufferHits_.fetch_add(1, std::memory_order_relaxed); }
     /// Call when BufferManager loads a page from disk.
     void incBufferMiss()  { bufferMisses_.fetch_add(1, std::memory_order_relaxed); }
+    /// Call when BufferManager evicts a page; `dirty` if it had to write it first.
+    void incBufferEviction(bool dirty) {
+        (dirty ? dirtyEvictions_ : cleanEvictions_).fetch_add(1, std::memory_order_relaxed);
+    }
+    /// Call when a buffer miss looks in the compressed page cache.
+    void incCompressedCacheLookup(bool hit) {
+        (hit ? ccHits_ : ccMisses_).fetch_add(1, std::memory_order_relaxed);
+    }
+    /// Call from the background writer about once a second.
+    void recordBgWriterFlushes(uint64_t pagesFlushed, uint64_t pagesPerSec) {
+        bgWriterPages_.fetch_add(pagesFlushed, std::memory_order_relaxed);
+        bgWriterRate_.store(pagesPerSec, std::memory_order_relaxed);
+    }
 
     /// Call at end of each query.
     void incQueryCount()  { queryCount_.fetch_add(1, std::memory_order_relaxed); }
@@ -37,14 +50,24 @@ public:
         uint64_t totalUs   = totalQueryLatencyUs_.load();
         uint64_t committed = txCommitted_.load();
         uint64_t aborted   = txAborted_.load();
+        uint64_t clean     = cleanEvictions_.load();
+        uint64_t dirty     = dirtyEvictions_.load();
 
         double avgLatMs = qcount>0
           ? (double)totalUs / (1000.0 * qcount)
           : 0.0;
+        double cleanPct = clean + dirty > 0
+          ? 100.0 * clean / (clean + dirty)
+          : 100.0;
 
         std::ostringstream oss;
         oss << "buffer_hits "      << hits      << "\n"
             << "buffer_misses "    << misses    << "\n"
+            << "buffer_clean_victim_pct " << cleanPct << "\n"
+            << "compressed_cache_hits "   << ccHits_.load()   << "\n"
+            << "compressed_cache_misses " << ccMisses_.load() << "\n"
+            << "bgwriter_pages_flushed "  << bgWriterPages_.load() << "\n"
+            << "bgwriter_flush_rate "     << bgWriterRate_.load()  << "\n"
             << "queries_executed " << qcount    << "\n"
             << "avg_query_ms "     << avgLatMs  << "\n"
             << "tx_committed "     << committed << "\n"
@@ -58,6 +81,12 @@ private:
 
     std::atomic<uint64_t> bufferHits_{0};
     std::atomic<uint64_t> bufferMisses_{0};
+    std::atomic<uint64_t> cleanEvictions_{0};
+    std::atomic<uint64_t> dirtyEvictions_{0};
+    std::atomic<uint64_t> ccHits_{0};
+    std::atomic<uint64_t> ccMisses_{0};
+    std::atomic<uint64_t> bgWriterPages_{0};
+    std::atomic<uint64_t> bgWriterRate_{0};   // pages/s over the last window
     std::atomic<uint64_t> queryCount_{0};
     std::atomic<uint64_t> totalQueryLatencyUs_{0};
     std::atomic<uint64_t> txCommitted_{0};
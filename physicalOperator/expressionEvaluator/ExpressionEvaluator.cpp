@@ -3,6 +3,55 @@
 #include "FunctionRegistry.h"
 #include <stdexcept>
 #include <algorithm>
+#include <string_view>
+
+namespace {
+
+// A comparison operand read without materializing it
+struct Scalar {
+    bool isInt = false;
+    int32_t i = 0;
+    std::string_view s;
+};
+
+// Literal or column operand; false for anything that needs full eval
+bool scalarOf(const Expr *expr, const RecordView &rec,
+              const std::unordered_map<std::string,int> &colIdx, Scalar &out) {
+    switch (expr->type) {
+        case Expr::Type::INT_LITERAL:
+            out.isInt = true;
+            out.i = expr->intValue;
+            return true;
+        case Expr::Type::STR_LITERAL:
+            out.s = expr->strValue;
+            return true;
+        case Expr::Type::COLUMN_REF: {
+            auto it = colIdx.find(expr->columnName);
+            if (it == colIdx.end())
+                throw std::runtime_error("Unknown column in eval: " + expr->columnName);
+            out.isInt = rec.type(it->second) == DataType::INT;
+            if (out.isInt) out.i = rec.getInt(it->second);
+            else out.s = rec.getString(it->second);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// 1/0 for a comparison operator, -1 if op is not one
+template<typename T>
+int compare(const std::string &op, const T &l, const T &r) {
+    if (op == "=")  return l == r;
+    if (op == "<>") return l != r;
+    if (op == "<")  return l < r;
+    if (op == ">")  return l > r;
+    if (op == "<=") return l <= r;
+    if (op == ">=") return l >= r;
+    return -1;
+}
+
+} // namespace
 
 FieldValue ExpressionEvaluator::eval(const Expr *expr,
                                      const physical::Row &row,
@@ -82,3 +131,24 @@ bool ExpressionEvaluator::evalBoolean(const Expr *expr,
         return std::get<int32_t>(v) != 0;
     throw std::runtime_error("Non-boolean result in predicate eval");
 }
+
+bool ExpressionEvaluator::evalBoolean(const Expr *expr,
+                                      const RecordView &rec,
+                                      const std::unordered_map<std::string,int> &colIdx) {
+    if (expr->type == Expr::Type::BINARY_OP) {
+        const std::string &op = expr->op;
+        if (op == "AND")
+            return evalBoolean(expr->left.get(), rec, colIdx)
+                && evalBoolean(expr->right.get(), rec, colIdx);
+        if (op == "OR")
+            return evalBoolean(expr->left.get(), rec, colIdx)
+                || evalBoolean(expr->right.get(), rec, colIdx);
+        Scalar l, r;
+        if (scalarOf(expr->left.get(), rec, colIdx, l) &&
+            scalarOf(expr->right.get(), rec, colIdx, r) && l.isInt == r.isInt) {
+            int res = l.isInt ? compare(op, l.i, r.i) : compare(op, l.s, r.s);
+            if (res >= 0) return res != 0;
+        }
+    }
+    return evalBoolean(expr, rec.values(), colIdx);
+}
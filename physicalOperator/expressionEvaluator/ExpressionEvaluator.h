@@ -4,6 +4,7 @@
 #include <string>
 #include "AST.h"
 #include "PhysicalOperator.h"
+#include "RecordView.h"
 
 class ExpressionEvaluator {
 public:
@@ -15,4 +16,10 @@ public:
     static bool evalBoolean(const Expr *expr,
                             const physical::Row &row,
                             const std::unordered_map<std::string,int> &colIdx);
+    // Evaluate predicate on a stored record. Comparisons of columns and
+    // literals (and AND/OR over them) read the record in place; anything
+    // else is evaluated on the materialized row.
+    static bool evalBoolean(const Expr *expr,
+                            const RecordView &rec,
+                            const std::unordered_map<std::string,int> &colIdx);
 };
\ No newline at end of file
@@ -1,9 +1,10 @@
 // File: TableScan.cpp
 #include "TableScan.h"
+#include "ExpressionEvaluator.h"
 #include <stdexcept>
 
 TableScan::TableScan(StorageEngine &se, Catalog &catalog, const std::string &tableName)
-    : se_(se), catalog_(catalog), table_(tableName), idx_(0) {
+    : se_(se), catalog_(catalog), table_(tableName) {
     // Build qualified column names
     Schema schema = catalog_.getTable(tableName);
     for (size_t i = 0; i < schema.numColumns(); ++i) {
@@ -15,20 +16,19 @@ TableScan::TableScan(StorageEngine &se, Catalog &catalog, const std::string &tab
 }
 
 void TableScan::open() {
-    rids_ = se_.scanTable(table_);
-    idx_ = 0;
+    cursor_ = se_.openScan(table_);
 }
 
 bool TableScan::next(physical::Row &row) {
-    while (idx_ < rids_.size()) {
-        RecordID rid = rids_[idx_++];
-        row = se_.fetchRecord(table_, rid);
+    while (cursor_.next()) {
+        RecordView rec = cursor_.view();
+        if (pred_ && !ExpressionEvaluator::evalBoolean(pred_, rec, colIdx_)) continue;
+        row = rec.values();
         return true;
     }
     return false;
 }
 
 void TableScan::close() {
-    rids_.clear();
-    idx_ = 0;
+    cursor_ = TableHeap::Cursor();
 }
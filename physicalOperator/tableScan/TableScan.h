@@ -3,6 +3,7 @@
 #include "PhysicalOperator.h"
 #include "StorageEngine.h"
 #include "Catalog.h"
+#include "AST.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -13,13 +14,17 @@ public:
     void open() override;
     bool next(physical::Row &row) override;
     void close() override;
+    // Filters inside the scan: the predicate runs on each stored record in
+    // place, and only rows it accepts are materialized
+    void setPredicate(const Expr *pred) { pred_ = pred; }
 
 private:
     StorageEngine &se_;
     Catalog &catalog_;
     std::string table_;
-    std::vector<RecordID> rids_;
-    size_t idx_;
+    // Streams the table page by page; nothing is materialized up front
+    TableHeap::Cursor cursor_;
+    const Expr *pred_ = nullptr;
     std::vector<std::string> colNames_;
     std::unordered_map<std::string,int> colIdx_;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
+#include <cstring>
 
 static std::string trim(const std::string &s) {
     auto b = s.find_first_not_of(" \t\r\n");
@@ -21,9 +22,11 @@ static bool iequals_prefix(const std::string &s, const char *p) {
     return true;
 }
 
-QueryEngine::QueryEngine(const std::string &catalogDir)
+QueryEngine::QueryEngine(const std::string &catalogDir, std::size_t bufferPoolPages,
+                         std::size_t maxBufferPoolPages)
   : fm_()
-  , bm_(fm_, 128)
+  , bm_(fm_, bufferPoolPages, 0, ReplacementPolicyKind::CLOCK, true,
+        std::max(bufferPoolPages, maxBufferPoolPages))
   , catalog_(catalogDir)
   , lockMgr_()
   , walMgr_(catalogDir + "/wal.log")
@@ -38,9 +41,23 @@ QueryEngine::QueryEngine(const std::string &catalogDir)
   , physGen_()
   , executor_()
   , currentTxId_(0)
+  , residentSetPath_(catalogDir + "/buffer_pool.resident")
 {
     // 1) Recover from WAL before serving anything
     walMgr_.recover(storage_);
+    // 2) Remember what is hot, for the next start's warm-up
+    bm_.startResidentSetSaver(residentSetPath_);
+}
+
+QueryEngine::~QueryEngine()
+{
+    // Final save while the tables' files are still open
+    bm_.stopResidentSetSaver();
+}
+
+void QueryEngine::warmUpBufferPool()
+{
+    bm_.startWarmUp(residentSetPath_);
 }
 
 void QueryEngine::registerTable(const std::string &name,
@@ -100,11 +117,45 @@ QueryEngine::executeQuery(const std::string &rawSql)
         return {};
     }
 
-    // 3) Parse & bind
+    // 3) SET name = value  (runtime settings)
+    if (iequals_prefix(sql, "SET") && sql.size() > 3 && std::isspace(sql[3])) {
+        std::string rest = trim(sql.substr(3));
+        if (!rest.empty() && rest.back() == ';') rest = trim(rest.substr(0, rest.size() - 1));
+        auto sep = rest.find_first_of(" \t=");
+        std::string name = rest.substr(0, sep);
+        std::string value = sep == std::string::npos ? "" : trim(rest.substr(sep));
+        // accept both "= value" and "TO value"
+        if (!value.empty() && value[0] == '=') value = trim(value.substr(1));
+        else if (iequals_prefix(value, "TO")) value = trim(value.substr(2));
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        std::string poolRange = std::to_string(bm_.numShards()) + ".." +
+                                std::to_string(bm_.maxPoolSize());
+        if (name != "buffer_pool_pages" && name != "compressed_cache_bytes")
+            throw std::runtime_error("Unknown setting: " + name +
+                                     " (buffer_pool_pages " + poolRange +
+                                     ", compressed_cache_bytes)");
+        if (value.empty() || value.size() > 18 ||
+            !std::all_of(value.begin(), value.end(),
+                         [](unsigned char c) { return std::isdigit(c); }))
+            throw std::runtime_error(name + " needs a non-negative number");
+        std::size_t n = std::stoull(value);
+        if (name == "buffer_pool_pages") {
+            if (n < bm_.numShards() || n > bm_.maxPoolSize())
+                throw std::runtime_error("buffer_pool_pages must be in " + poolRange +
+                                         " (the maximum is fixed at startup)");
+            bm_.setPoolSize(n);
+        } else {
+            bm_.setCompressedCacheBytes(n);
+        }
+        return {};
+    }
+
+    // 4) Parse & bind
     AST ast = parser_.parse(sql);
     binder_.bind(ast);
 
-    // 4) DML (inside transaction)
+    // 5) DML (inside transaction)
     if (ast.isInsert() || ast.isUpdate() || ast.isDelete()) {
         if (currentTxId_ == 0)
             throw std::runtime_error("DML must be inside a transaction");
@@ -129,7 +180,7 @@ QueryEngine::executeQuery(const std::string &rawSql)
         return {};
     }
 
-    // 5) SELECT
+    // 6) SELECT
     if (ast.isSelect()) {
         auto t0 = std::chrono::steady_clock::now();
         auto lplan = planner_.buildLogicalPlan(ast);
@@ -23,7 +23,15 @@ namespace physical { using Row = std::vector<FieldValue>; }
 
 class QueryEngine {
 public:
-    explicit QueryEngine(const std::string &catalogDir);
+    // bufferPoolPages is the initial pool size; SET buffer_pool_pages = N
+    // resizes it later, up to maxBufferPoolPages (address space for that
+    // many pages is reserved up front)
+    explicit QueryEngine(const std::string &catalogDir,
+                         std::size_t bufferPoolPages = 128,
+                         std::size_t maxBufferPoolPages = DEFAULT_MAX_BUFFER_POOL_PAGES);
+    ~QueryEngine();
+
+    static constexpr std::size_t DEFAULT_MAX_BUFFER_POOL_PAGES = 1 << 17;  // 1 GiB
 
     std::vector<physical::Row> executeQuery(const std::string &sql);
 
@@ -33,6 +41,11 @@ public:
                        const std::string &indexFile,
                        const std::string &pkColumn);
 
+    // Reloads the buffer pool's saved resident set in the background. Call
+    // once the tables are registered: pages of files that are not open yet
+    // are skipped.
+    void warmUpBufferPool();
+
 private:
     FileManager           fm_;
     BufferManager         bm_;
@@ -52,4 +65,6 @@ private:
     Executor              executor_;
 
     int64_t               currentTxId_ = 0;
+    // Resident set saved periodically and at shutdown, for warmUpBufferPool
+    std::string           residentSetPath_;
 };
@@ -49,6 +49,12 @@ private:
                 auto *f = static_cast<LogicalFilter*>(node);
                 // Child inherits current colIdx
                 auto *childOp = gen(f->children[0], colIdx);
+                // Directly over a scan, filter on the stored records instead
+                // of materializing rows only to drop them
+                if (f->children[0]->opType == LogicalOpType::SeqScan && f->predicate) {
+                    static_cast<TableScan*>(childOp)->setPredicate(f->predicate);
+                    return childOp;
+                }
                 return new Filter(childOp, f->predicate, colIdx);
             }
             case LogicalOpType::Project: {
@@ -1,5 +1,6 @@
 // File: Record.cpp
 #include "Record.h"
+#include "RecordView.h"
 #include <cstring>
 #include <stdexcept>
 
@@ -8,21 +9,24 @@ Record::Record(const Schema &schema)
 
 Record::Record(const Schema &schema, const std::vector<FieldValue> &values)
     : schema_(schema), values_(values) {
-    if (values_.size() != schema_.numColumns()) {
+    validate(schema_, values_);
+}
+
+void Record::validate(const Schema &schema, const std::vector<FieldValue> &values) {
+    if (values.size() != schema.numColumns()) {
         throw std::runtime_error("Value count does not match schema column count");
     }
-    // Optionally: validate types and string lengths
-    for (std::size_t i = 0; i < values_.size(); ++i) {
-        const Column &col = schema_.getColumn(i);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const Column &col = schema.getColumn(i);
         if (col.type == DataType::INT) {
-            if (!std::holds_alternative<int32_t>(values_[i])) {
+            if (!std::holds_alternative<int32_t>(values[i])) {
                 throw std::runtime_error("Type mismatch: expected INT");
             }
         } else if (col.type == DataType::STRING) {
-            if (!std::holds_alternative<std::string>(values_[i])) {
+            if (!std::holds_alternative<std::string>(values[i])) {
                 throw std::runtime_error("Type mismatch: expected STRING");
             }
-            const auto &s = std::get<std::string>(values_[i]);
+            const auto &s = std::get<std::string>(values[i]);
             if (s.size() > col.length) {
                 throw std::runtime_error("STRING value exceeds defined column length");
             }
@@ -31,52 +35,66 @@ Record::Record(const Schema &schema, const std::vector<FieldValue> &values)
 }
 
 std::vector<char> Record::serialize() const {
-    std::size_t recSize = schema_.getRecordSize();
-    std::vector<char> buffer(recSize);
-    std::size_t offset = 0;
+    std::vector<char> buffer(schema_.getRecordSize());
+    serializeInto(schema_, values_, buffer.data());
+    return buffer;
+}
 
-    for (std::size_t i = 0; i < values_.size(); ++i) {
-        const Column &col = schema_.getColumn(i);
+void Record::serializeInto(const Schema &schema, const std::vector<FieldValue> &values,
+                           char *dst) {
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const Column &col = schema.getColumn(i);
         if (col.type == DataType::INT) {
-            int32_t v = std::get<int32_t>(values_[i]);
-            std::memcpy(buffer.data() + offset, &v, sizeof(v));
+            int32_t v = std::get<int32_t>(values[i]);
+            std::memcpy(dst + offset, &v, sizeof(v));
             offset += sizeof(v);
         } else {
-            const std::string &s = std::get<std::string>(values_[i]);
+            const std::string &s = std::get<std::string>(values[i]);
             std::size_t len = s.size();
-            std::memcpy(buffer.data() + offset, s.data(), len);
+            std::memcpy(dst + offset, s.data(), len);
             // pad remaining bytes with zeros
-            std::memset(buffer.data() + offset + len, 0, col.length - len);
+            std::memset(dst + offset + len, 0, col.length - len);
             offset += col.length;
         }
     }
-    return buffer;
 }
 
 Record Record::deserialize(const Schema &schema, const char *buffer) {
-    std::size_t offset = 0;
-    std::vector<FieldValue> values;
-    values.reserve(schema.numColumns());
+    return Record(Unchecked{}, schema,
+                  RecordView(schema, buffer, RecordView::Format::FIXED).values());
+}
 
-    for (std::size_t i = 0; i < schema.numColumns(); ++i) {
-        const Column &col = schema.getColumn(i);
-        if (col.type == DataType::INT) {
-            int32_t v;
-            std::memcpy(&v, buffer + offset, sizeof(v));
-            values.emplace_back(v);
-            offset += sizeof(v);
+std::size_t Record::packedSize(const Schema &schema, const std::vector<FieldValue> &values) {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (schema.getColumn(i).type == DataType::INT)
+            size += sizeof(int32_t);
+        else
+            size += sizeof(std::uint16_t) + std::get<std::string>(values[i]).size();
+    }
+    return size;
+}
+
+void Record::packInto(const Schema &schema, const std::vector<FieldValue> &values, char *dst) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (schema.getColumn(i).type == DataType::INT) {
+            int32_t v = std::get<int32_t>(values[i]);
+            std::memcpy(dst, &v, sizeof(v));
+            dst += sizeof(v);
         } else {
-            // Read fixed-length string and remove trailing zeros
-            std::string s;
-            s.assign(buffer + offset, col.length);
-            auto pos = s.find('\0');
-            if (pos != std::string::npos) s.resize(pos);
-            values.emplace_back(s);
-            offset += col.length;
+            const std::string &s = std::get<std::string>(values[i]);
+            auto len = static_cast<std::uint16_t>(s.size());
+            std::memcpy(dst, &len, sizeof(len));
+            std::memcpy(dst + sizeof(len), s.data(), len);
+            dst += sizeof(len) + len;
         }
     }
+}
 
-    return Record(schema, values);
+Record Record::unpack(const Schema &schema, const char *buffer) {
+    return Record(Unchecked{}, schema,
+                  RecordView(schema, buffer, RecordView::Format::PACKED).values());
 }
 
 const std::vector<FieldValue> &Record::getValues() const {
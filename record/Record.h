@@ -2,9 +2,11 @@
 #pragma once
 
 #include "Schema.h"
+#include <cstdint>
 #include <variant>
 #include <vector>
 #include <string>
+#include <utility>
 
 using FieldValue = std::variant<int32_t, std::string>;
 
@@ -17,13 +19,33 @@ public:
 
     // Serialize record into contiguous byte array
     std::vector<char> serialize() const;
-    // Deserialize record from buffer
+    // Checks values against the schema (count, types, string lengths);
+    // throws std::runtime_error on mismatch
+    static void validate(const Schema &schema, const std::vector<FieldValue> &values);
+    // Serializes already validated values straight into dst
+    // (schema.getRecordSize() bytes), e.g. a page slot
+    static void serializeInto(const Schema &schema, const std::vector<FieldValue> &values,
+                              char *dst);
+    // Deserialize record from buffer (see RecordView to read fields
+    // without copying them)
     static Record deserialize(const Schema &schema, const char *buffer);
 
+    // Variable-length encoding used by slotted heap pages: INT as 4 bytes,
+    // STRING as a 2-byte length followed by its bytes, without padding.
+    // Values must already be validated.
+    static std::size_t packedSize(const Schema &schema, const std::vector<FieldValue> &values);
+    static void packInto(const Schema &schema, const std::vector<FieldValue> &values, char *dst);
+    static Record unpack(const Schema &schema, const char *buffer);
+
     // Access values
     const std::vector<FieldValue> &getValues() const;
 
 private:
+    struct Unchecked {};
+    // Adopts values read back from storage, which were validated when written
+    Record(Unchecked, const Schema &schema, std::vector<FieldValue> values)
+        : schema_(schema), values_(std::move(values)) {}
+
     const Schema &schema_;
     std::vector<FieldValue> values_;
 };
\ No newline at end of file
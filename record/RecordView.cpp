@@ -0,0 +1,75 @@
+// File: RecordView.cpp
+#include "RecordView.h"
+#include <cstring>
+#include <stdexcept>
+
+const char *RecordView::field(std::size_t col) const {
+    // Up to the first STRING both formats share the schema's offsets
+    std::size_t first = schema_->firstStringColumn();
+    if (format_ == Format::FIXED || col <= first)
+        return data_ + schema_->columnOffset(col);
+    const char *p = data_ + schema_->columnOffset(first);
+    for (std::size_t i = first; i < col; ++i) {
+        if (schema_->getColumn(i).type == DataType::INT) {
+            p += sizeof(int32_t);
+        } else {
+            std::uint16_t len;
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len) + len;
+        }
+    }
+    return p;
+}
+
+int32_t RecordView::getInt(std::size_t col) const {
+    if (type(col) != DataType::INT)
+        throw std::runtime_error("Type mismatch: expected INT");
+    int32_t v;
+    std::memcpy(&v, field(col), sizeof(v));
+    return v;
+}
+
+std::string_view RecordView::getString(std::size_t col) const {
+    const Column &c = schema_->getColumn(col);
+    if (c.type != DataType::STRING)
+        throw std::runtime_error("Type mismatch: expected STRING");
+    const char *p = field(col);
+    if (format_ == Format::PACKED) {
+        std::uint16_t len;
+        std::memcpy(&len, p, sizeof(len));
+        return {p + sizeof(len), len};
+    }
+    // Fixed-width strings are zero padded
+    auto *end = static_cast<const char *>(std::memchr(p, '\0', c.length));
+    return {p, end ? static_cast<std::size_t>(end - p) : c.length};
+}
+
+FieldValue RecordView::value(std::size_t col) const {
+    if (type(col) == DataType::INT) return getInt(col);
+    return std::string(getString(col));
+}
+
+std::vector<FieldValue> RecordView::values() const {
+    std::vector<FieldValue> out;
+    out.reserve(numColumns());
+    if (format_ == Format::FIXED) {
+        for (std::size_t i = 0; i < numColumns(); ++i) out.push_back(value(i));
+        return out;
+    }
+    // One pass instead of re-walking the record for every column
+    const char *p = data_;
+    for (std::size_t i = 0; i < numColumns(); ++i) {
+        if (type(i) == DataType::INT) {
+            int32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            out.emplace_back(v);
+            p += sizeof(v);
+        } else {
+            std::uint16_t len;
+            std::memcpy(&len, p, sizeof(len));
+            out.emplace_back(std::string(p + sizeof(len), len));
+            p += sizeof(len) + len;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,48 @@
+// File: RecordView.h
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Record.h"
+#include "Schema.h"
+
+// Read-only view of one stored record, decoding fields in place: INTs are
+// read straight from the bytes and STRINGs come back as string_views into
+// them, so looking at a record allocates nothing. Values are only built
+// (value/values) when a caller needs to keep them.
+//
+// The bytes are not copied: they must stay valid while the view is used,
+// e.g. a pinned page or a scan cursor's current page. The schema must
+// outlive the view too.
+class RecordView {
+public:
+    // Encoding of the viewed bytes
+    enum class Format {
+        FIXED,   // Record::serialize, column offsets from the schema
+        PACKED   // Record::packInto, length-prefixed STRINGs
+    };
+
+    RecordView() = default;
+    RecordView(const Schema &schema, const char *data, Format format)
+        : schema_(&schema), data_(data), format_(format) {}
+
+    std::size_t numColumns() const { return schema_->numColumns(); }
+    DataType type(std::size_t col) const { return schema_->getColumn(col).type; }
+
+    // Typed field access; throws std::runtime_error on a type mismatch
+    int32_t getInt(std::size_t col) const;
+    std::string_view getString(std::size_t col) const;
+
+    // Materialized copies
+    FieldValue value(std::size_t col) const;
+    std::vector<FieldValue> values() const;
+
+private:
+    // First byte of a column (for PACKED STRINGs, its length prefix)
+    const char *field(std::size_t col) const;
+
+    const Schema *schema_ = nullptr;
+    const char *data_ = nullptr;
+    Format format_ = Format::FIXED;
+};
@@ -3,8 +3,10 @@
 #include <stdexcept>
 
 Schema::Schema(const std::vector<Column> &cols)
-    : columns_(cols), recordSize_(0) {
-    for (const auto &col : columns_) {
+    : columns_(cols), recordSize_(0), firstString_(cols.size()) {
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        const Column &col = columns_[i];
+        offsets_.push_back(recordSize_);
         switch (col.type) {
             case DataType::INT:
                 recordSize_ += sizeof(int32_t);
@@ -14,6 +16,7 @@ Schema::Schema(const std::vector<Column> &cols)
                     throw std::runtime_error("STRING column must have positive length");
                 }
                 recordSize_ += col.length;
+                if (firstString_ == columns_.size()) firstString_ = i;
                 break;
         }
     }
@@ -26,8 +26,15 @@ public:
     std::size_t numColumns() const;
     // Access column definitions
     const Column &getColumn(std::size_t idx) const;
+    // Byte offset of a column within a fixed-width (serialized) record
+    std::size_t columnOffset(std::size_t idx) const { return offsets_.at(idx); }
+    // Index of the first STRING column, numColumns() if none. Columns up to
+    // and including it sit at the same offset in packed records too.
+    std::size_t firstStringColumn() const { return firstString_; }
 
 private:
     std::vector<Column> columns_;
     std::size_t recordSize_;
+    std::vector<std::size_t> offsets_;
+    std::size_t firstString_;
 };
\ No newline at end of file
@@ -9,17 +9,20 @@ void StorageEngine::registerTable(const std::string &tableName,
                                   const Schema &schema,
                                   const std::string &dataFile,
                                   const std::string &indexFile,
-                                  const std::string &primaryKeyColumn) {
+                                  const std::string &primaryKeyColumn,
+                                  PageCompression compression,
+                                  PageLayout layout) {
     if (tables_.count(tableName))
         throw std::runtime_error("Table already registered: " + tableName);
 
     // Open or create underlying files
-    fm_.openFile(dataFile);
-    fm_.openFile(indexFile);
+    fm_.openFile(dataFile, compression);
+    int indexFileId = fm_.openFile(indexFile, compression);
+    fm_.setExtentSize(indexFileId, INDEX_EXTENT_PAGES);
 
     // Construct heap and index
-    auto heap = std::make_unique<TableHeap>(fm_, bm_, dataFile, schema);
-    auto idx  = std::make_unique<BPlusTree<int32_t, RecordID>>(fm_.openFile(indexFile), bm_);
+    auto heap = std::make_unique<TableHeap>(fm_, bm_, dataFile, schema, compression, layout);
+    auto idx  = std::make_unique<BPlusTree<int32_t, RecordID>>(indexFileId, bm_);
 
     // Locate PK column index
     int pkIdx = -1;
@@ -55,6 +58,28 @@ RecordID StorageEngine::insertRecord(const std::string &tableName,
     return rid;
 }
 
+std::vector<RecordID> StorageEngine::insertBatch(const std::string &tableName,
+                                                 const std::vector<std::vector<FieldValue>> &rows) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end())
+        throw std::runtime_error("Unknown table: " + tableName);
+    TableInfo &ti = it->second;
+
+    for (const auto &row : rows) {
+        if (ti.pkColIdx >= static_cast<int>(row.size()) ||
+            !std::holds_alternative<int32_t>(row[ti.pkColIdx]))
+            throw std::runtime_error("Primary key must be INT");
+    }
+
+    std::vector<RecordID> rids = ti.heap->insertBatch(rows);
+    std::vector<std::pair<int32_t, RecordID>> entries;
+    entries.reserve(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i)
+        entries.emplace_back(std::get<int32_t>(rows[i][ti.pkColIdx]), rids[i]);
+    ti.index->bulkLoad(std::move(entries));
+    return rids;
+}
+
 bool StorageEngine::deleteByKey(const std::string &tableName, int32_t key) {
     auto it = tables_.find(tableName);
     if (it == tables_.end())
@@ -108,16 +133,31 @@ std::vector<RecordID> StorageEngine::scanTable(const std::string &tableName) con
     return ti.heap->tableScan();
 }
 
+TableHeap::Cursor StorageEngine::openScan(const std::string &tableName,
+                                         AccessStrategy strategy) const {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end())
+        throw std::runtime_error("Unknown table: " + tableName);
+    return it->second.heap->scan(strategy);
+}
+
 std::vector<FieldValue> StorageEngine::fetchRecord(const std::string &tableName,
-    const RecordID &rid) const {
+    const RecordID &rid, AccessStrategy strategy) const {
     auto it = tables_.find(tableName);
     if (it == tables_.end())
     throw std::runtime_error("Unknown table: " + tableName);
     const TableInfo &ti = it->second;
-    Record rec = ti.heap->getRecord(rid);
+    Record rec = ti.heap->getRecord(rid, strategy);
     return rec.getValues();
 }
 
+void StorageEngine::setMappedReads(const std::string &tableName, bool enabled) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end())
+        throw std::runtime_error("Unknown table: " + tableName);
+    it->second.heap->setMappedReads(enabled);
+}
+
 void StorageEngine::redoInsert(const std::string &table, 
     const RecordID &rid, 
     const std::vector<FieldValue> &vals) 
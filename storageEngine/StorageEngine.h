@@ -18,17 +18,27 @@ class StorageEngine {
 public:
     StorageEngine(FileManager &fm, BufferManager &bm);
 
-    // Register a table with data file, index file, schema, and primary key column
+    // Register a table with data file, index file, schema, and primary key column.
+    // New data and index files are created with the given page compression,
+    // and a new data file with the given record layout.
     void registerTable(const std::string &tableName,
                        const Schema &schema,
                        const std::string &dataFile,
                        const std::string &indexFile,
-                       const std::string &primaryKeyColumn);
+                       const std::string &primaryKeyColumn,
+                       PageCompression compression = PageCompression::NONE,
+                       PageLayout layout = PageLayout::FIXED);
 
     // Insert record and update primary-key index
     RecordID insertRecord(const std::string &tableName,
                           const std::vector<FieldValue> &values);
 
+    // Bulk insert: rows are appended to fresh heap pages and their keys
+    // loaded into the index sorted (bottom-up when the index is empty).
+    // All primary keys are checked before anything is written.
+    std::vector<RecordID> insertBatch(const std::string &tableName,
+                                      const std::vector<std::vector<FieldValue>> &rows);
+
     // Delete record by primary key
     bool deleteByKey(const std::string &tableName, int32_t key);
 
@@ -44,9 +54,20 @@ public:
 
     // Scan all records (returns RecordIDs)
     std::vector<RecordID> scanTable(const std::string &tableName) const;
-    std::vector<FieldValue> fetchRecord(const std::string &tableName, const RecordID &rid) const;
+    // Streaming scan: one page in memory at a time (see TableHeap::Cursor)
+    TableHeap::Cursor openScan(const std::string &tableName,
+                               AccessStrategy strategy = AccessStrategy::BULK_READ) const;
+    std::vector<FieldValue> fetchRecord(const std::string &tableName, const RecordID &rid,
+                                        AccessStrategy strategy = AccessStrategy::NORMAL) const;
+
+    // Route scans/fetches of a cold table through a read-only mmap instead
+    // of the buffer pool (see TableHeap::setMappedReads)
+    void setMappedReads(const std::string &tableName, bool enabled);
 
 private:
+    // Index files grow more slowly than heaps; reserve 256 KiB at a time
+    static constexpr int INDEX_EXTENT_PAGES = 32;
+
     struct TableInfo {
         Schema schema;
         std::unique_ptr<TableHeap> heap;
@@ -66,6 +66,67 @@ RecordID StorageEngine::insertRecord(const std::string &tableName,
     return rid;
 }
 
+std::vector<RecordID> StorageEngine::insertBatch(const std::string &tableName,
+                                                 const std::vector<std::string> &cols,
+                                                 const std::vector<std::vector<FieldValue>> &rows,
+                                                 int64_t txId)
+{
+    auto &td = tables_.at(tableName);
+    auto &sch = catalog_.getTableSchema(tableName);
+
+    // 1) lock
+    lockMgr_.lockExclusive(txId, "table:" + tableName);
+
+    // 2) build full field vectors
+    std::vector<int> colIdx;
+    for (auto &c : cols) {
+        int idx = sch.columnIndex(c);
+        if (idx < 0) throw std::runtime_error("Unknown column " + c);
+        colIdx.push_back(idx);
+    }
+    std::vector<std::vector<FieldValue>> full;
+    full.reserve(rows.size());
+    for (auto &vals : rows) {
+        std::vector<FieldValue> fv(sch.numColumns());
+        for (size_t i = 0; i < colIdx.size() && i < vals.size(); i++)
+            fv[colIdx[i]] = vals[i];
+        for (int i = 0; i < sch.numColumns(); i++) {
+            if (!fv[i].has_value())
+                fv[i] = sch.defaultFor(i);
+        }
+        full.push_back(std::move(fv));
+    }
+    // Reject the batch before anything reaches the heap or the log
+    for (const auto &fv : full) {
+        if (td.pkColIdx >= static_cast<int>(fv.size()) ||
+            !std::holds_alternative<int32_t>(fv[td.pkColIdx]))
+            throw std::runtime_error("Primary key must be INT");
+    }
+
+    // 3) do the insert
+    std::vector<RecordID> rids = td.heap->insertBatch(full);
+
+    // 4) log it, one record per run of slots on a page
+    size_t start = 0;
+    for (size_t i = 1; i <= rids.size(); i++) {
+        if (i < rids.size() && rids[i].pageId == rids[start].pageId &&
+            rids[i].slotNum == rids[i-1].slotNum + 1)
+            continue;
+        walMgr_.logInsertPage(txId, tableName, rids[start],
+                              full.begin() + start, full.begin() + i);
+        start = i;
+    }
+
+    // 5) index
+    std::vector<std::pair<int32_t, RecordID>> entries;
+    entries.reserve(rids.size());
+    for (size_t i = 0; i < rids.size(); i++)
+        entries.emplace_back(std::get<int32_t>(full[i][td.pkColIdx]), rids[i]);
+    td.index->bulkLoad(std::move(entries));
+
+    return rids;
+}
+
 void StorageEngine::deleteRecords(const std::string &tableName,
                                   Expr *where,
                                   int64_t txId)
@@ -122,10 +183,11 @@ void StorageEngine::updateRecords(const std::string &tableName,
 
 std::vector<FieldValue>
 StorageEngine::getRecord(const std::string &tableName,
-                         const RecordID &rid)
+                         const RecordID &rid,
+                         AccessStrategy strategy)
 {
     auto &td = tables_.at(tableName);
-    return td.heap->getRecord(rid);
+    return td.heap->getRecord(rid, strategy);
 }
 
 std::vector<RecordID>
@@ -137,3 +199,26 @@ StorageEngine::scanTable(const std::string &tableName,
     lockMgr_.lockShared(txId, "table:" + tableName);
     return td.heap->tableScan();
 }
+
+TableHeap::Cursor
+StorageEngine::openScan(const std::string &tableName,
+                        int64_t txId,
+                        AccessStrategy strategy)
+{
+    auto &td = tables_.at(tableName);
+    // shared lock for the whole table
+    lockMgr_.lockShared(txId, "table:" + tableName);
+    return td.heap->scan(strategy);
+}
+
+void StorageEngine::prefetchForRedo(const std::string &tableName,
+                                    const RecordID &rid)
+{
+    auto it = tables_.find(tableName);
+    if (it != tables_.end()) it->second.heap->prefetchPage(rid.pageId);
+}
+
+void StorageEngine::checkpoint()
+{
+    bm_.flushAllPages();
+}
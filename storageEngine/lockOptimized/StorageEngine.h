@@ -37,6 +37,13 @@ public:
                           const std::vector<FieldValue> &vals,
                           int64_t txId);
 
+    // Bulk insert of rows naming the same columns: appended to fresh heap
+    // pages, one WAL record per page, keys bulk-loaded into the index
+    std::vector<RecordID> insertBatch(const std::string &tableName,
+                                      const std::vector<std::string> &cols,
+                                      const std::vector<std::vector<FieldValue>> &rows,
+                                      int64_t txId);
+
     void deleteRecords(const std::string &tableName,
                        Expr *where,
                        int64_t txId);
@@ -47,11 +54,17 @@ public:
                        int64_t txId);
 
     std::vector<FieldValue> getRecord(const std::string &tableName,
-                                      const RecordID &rid);
+                                      const RecordID &rid,
+                                      AccessStrategy strategy = AccessStrategy::NORMAL);
 
     std::vector<RecordID> scanTable(const std::string &tableName,
                                     int64_t txId);
 
+    // Streaming scan under the same table lock as scanTable
+    TableHeap::Cursor openScan(const std::string &tableName,
+                               int64_t txId,
+                               AccessStrategy strategy = AccessStrategy::BULK_READ);
+
     // in StorageEngine.h (public API)
     /// Replay‐level calls from WAL recovery
     void redoInsert(const std::string &tableName,
@@ -65,6 +78,13 @@ public:
         const RecordID &rid,
         const std::vector<FieldValue> &newValues);
 
+    /// Start reading the page a later redo call will touch
+    void prefetchForRedo(const std::string &tableName, const RecordID &rid);
+
+    /// Write back every dirty page and sync all files; after this the
+    /// log records covering those pages are no longer needed.
+    void checkpoint();
+
 
 private:
     struct TableData {
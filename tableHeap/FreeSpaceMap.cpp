@@ -0,0 +1,76 @@
+// File: FreeSpaceMap.cpp
+#include "FreeSpaceMap.h"
+#include "PageGuard.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+std::uint16_t entryAt(const char *page, int idx) {
+    std::uint16_t v;
+    std::memcpy(&v, page + idx * sizeof(v), sizeof(v));
+    return v;
+}
+
+} // namespace
+
+FreeSpaceMap::FreeSpaceMap(FileManager &fm, BufferManager &bm, const std::string &path)
+    : fm_(fm), bm_(bm) {
+    fileId_ = fm_.openFile(path);
+}
+
+int FreeSpaceMap::get(int heapPage) const {
+    int mapPage = heapPage / ENTRIES_PER_PAGE;
+    if (mapPage >= fm_.getPageCount(fileId_)) return UNKNOWN;
+    ReadPageGuard page(bm_, fileId_, mapPage);
+    std::uint16_t v = entryAt(page.data(), heapPage % ENTRIES_PER_PAGE);
+    return v == 0 ? UNKNOWN : v - 1;
+}
+
+void FreeSpaceMap::set(int heapPage, int free) {
+    int mapPage = heapPage / ENTRIES_PER_PAGE;
+    ensurePage(mapPage);
+    // A page holding more slots than the heap now allows (an older file)
+    // reports negative space: record it as full, not as unknown
+    auto v = static_cast<std::uint16_t>(std::clamp(free, 0, 65534) + 1);
+    {
+        // Skip the write latch (and dirtying the page) when nothing changes
+        ReadPageGuard page(bm_, fileId_, mapPage);
+        if (entryAt(page.data(), heapPage % ENTRIES_PER_PAGE) == v) return;
+    }
+    WritePageGuard page(bm_, fileId_, mapPage);
+    std::memcpy(page.data() + (heapPage % ENTRIES_PER_PAGE) * sizeof(v), &v, sizeof(v));
+}
+
+int FreeSpaceMap::find(int start, int pageCount, int minFree) const {
+    if (pageCount <= 0) return -1;
+    start = std::clamp(start, 0, pageCount - 1);
+    int found = scan(start, pageCount, minFree);
+    if (found < 0 && start > 0) found = scan(0, start, minFree);
+    return found;
+}
+
+void FreeSpaceMap::ensurePage(int mapPage) {
+    if (mapPage < fm_.getPageCount(fileId_)) return;
+    std::lock_guard<std::mutex> guard(growLatch_);
+    // New map pages read back as zeros: every entry unknown
+    while (fm_.getPageCount(fileId_) <= mapPage) fm_.allocatePage(fileId_);
+}
+
+int FreeSpaceMap::scan(int from, int to, int minFree) const {
+    int mapPages = fm_.getPageCount(fileId_);
+    int heapPage = from;
+    while (heapPage < to) {
+        int mapPage = heapPage / ENTRIES_PER_PAGE;
+        // Past the end of the map: nothing is known about these pages
+        if (mapPage >= mapPages) return heapPage;
+        int end = std::min(to, (mapPage + 1) * ENTRIES_PER_PAGE);
+        ReadPageGuard page(bm_, fileId_, mapPage);
+        for (; heapPage < end; ++heapPage) {
+            // 0 is unknown, which may have room
+            std::uint16_t v = entryAt(page.data(), heapPage % ENTRIES_PER_PAGE);
+            if (v == 0 || v > minFree) return heapPage;
+        }
+    }
+    return -1;
+}
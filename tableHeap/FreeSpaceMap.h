@@ -0,0 +1,54 @@
+// File: FreeSpaceMap.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "BufferManager.h"
+#include "FileManager.h"
+
+// Persistent per-page summary of a heap file's free space, kept in a
+// sidecar file (<table>.fsm) that goes through the buffer pool like any
+// other page. The unit is the heap's business: free slots (unused slot
+// capacity plus tombstones) for fixed-width pages, free bytes for slotted
+// ones. Each heap page has a 16-bit entry holding free + 1; 0 means
+// "unknown", which is what a
+// fresh map, a map page never written, or a page past the map's end reads
+// as. Unknown pages are offered to inserters, who look at the page itself
+// and record what they find, so a missing or partly lost map repairs
+// itself instead of needing a rebuild.
+//
+// The map is a hint, not WAL-logged: inserters always re-check the heap
+// page under its write latch and correct the entry when it was wrong.
+// Latch order: a heap page's latch may be held while updating the map,
+// never the other way round.
+class FreeSpaceMap {
+public:
+    static constexpr int UNKNOWN = -1;
+
+    FreeSpaceMap(FileManager &fm, BufferManager &bm, const std::string &path);
+
+    // Free space recorded for heapPage, or UNKNOWN
+    int get(int heapPage) const;
+    // Records heapPage's free space (clamped to [0, 65534])
+    void set(int heapPage, int free);
+    // First heap page in [0, pageCount) with at least minFree free or
+    // unknown, searching upward from `start` and wrapping around; -1 if none
+    int find(int start, int pageCount, int minFree = 1) const;
+
+private:
+    static constexpr int ENTRIES_PER_PAGE =
+        static_cast<int>(FileManager::USABLE_PAGE_SIZE / sizeof(std::uint16_t));
+
+    // Makes sure the map file has a page for entries of mapPage
+    void ensurePage(int mapPage);
+    // Lowest page in [from, to) with at least minFree free or unknown, or -1
+    int scan(int from, int to, int minFree) const;
+
+    FileManager &fm_;
+    BufferManager &bm_;
+    int fileId_;
+    // Serializes growing the map file
+    std::mutex growLatch_;
+};
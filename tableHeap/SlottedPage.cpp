@@ -0,0 +1,119 @@
+// File: SlottedPage.cpp
+#include "SlottedPage.h"
+#include <cstring>
+
+namespace {
+
+std::uint16_t load16(const char *p) {
+    std::uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void store16(char *p, std::size_t v) {
+    auto x = static_cast<std::uint16_t>(v);
+    std::memcpy(p, &x, sizeof(x));
+}
+
+const char *entry(const char *page, int slot) {
+    return page + SlottedPage::HEADER_SIZE + slot * SlottedPage::ENTRY_SIZE;
+}
+
+char *entry(char *page, int slot) {
+    return page + SlottedPage::HEADER_SIZE + slot * SlottedPage::ENTRY_SIZE;
+}
+
+std::size_t dataStart(const char *page) {
+    std::uint16_t v = load16(page + sizeof(std::uint16_t));
+    return v == 0 ? FileManager::USABLE_PAGE_SIZE : v;
+}
+
+void setDataStart(char *page, std::size_t v) {
+    store16(page + sizeof(std::uint16_t), v == FileManager::USABLE_PAGE_SIZE ? 0 : v);
+}
+
+} // namespace
+
+int SlottedPage::numSlots(const char *page) {
+    return load16(page);
+}
+
+const char *SlottedPage::record(const char *page, int slot) {
+    if (slot < 0 || slot >= numSlots(page)) return nullptr;
+    std::uint16_t offset = load16(entry(page, slot));
+    return offset == 0 ? nullptr : page + offset;
+}
+
+std::size_t SlottedPage::recordLength(const char *page, int slot) {
+    return load16(entry(page, slot) + sizeof(std::uint16_t));
+}
+
+std::size_t SlottedPage::freeSpace(const char *page) {
+    int n = numSlots(page);
+    std::size_t used = n * ENTRY_SIZE;
+    for (int i = 0; i < n; ++i) {
+        if (load16(entry(page, i)) != 0) used += recordLength(page, i);
+    }
+    return CAPACITY - used;
+}
+
+int SlottedPage::firstFreeSlot(const char *page) {
+    int n = numSlots(page);
+    int slot = 0;
+    while (slot < n && load16(entry(page, slot)) != 0) ++slot;
+    return slot;
+}
+
+char *SlottedPage::allocate(char *page, int slot, std::size_t len) {
+    int n = numSlots(page);
+    bool live = slot < n && load16(entry(page, slot)) != 0;
+    std::size_t oldLen = live ? recordLength(page, slot) : 0;
+    if (live && len <= oldLen) {
+        // Shrinking in place; the tail becomes a hole
+        store16(entry(page, slot) + sizeof(std::uint16_t), len);
+        return page + load16(entry(page, slot));
+    }
+    int newSlots = slot < n ? 0 : slot + 1 - n;
+    std::size_t dirEnd = HEADER_SIZE + (n + newSlots) * ENTRY_SIZE;
+    // Counting the holes is only needed when the contiguous gap is too small
+    bool fitsGap = dataStart(page) >= dirEnd + len;
+    if (!fitsGap && len + newSlots * ENTRY_SIZE > freeSpace(page) + oldLen) return nullptr;
+
+    if (live) store16(entry(page, slot), 0);
+    // Compact before growing the directory, which may reach into the
+    // space the lowest records occupy until then
+    if (!fitsGap) compact(page);
+    for (int i = n; i < n + newSlots; ++i) {
+        store16(entry(page, i), 0);
+        store16(entry(page, i) + sizeof(std::uint16_t), 0);
+    }
+    store16(page, n + newSlots);
+
+    std::size_t offset = dataStart(page) - len;
+    setDataStart(page, offset);
+    store16(entry(page, slot), offset);
+    store16(entry(page, slot) + sizeof(std::uint16_t), len);
+    return page + offset;
+}
+
+void SlottedPage::erase(char *page, int slot) {
+    if (slot < 0 || slot >= numSlots(page)) return;
+    store16(entry(page, slot), 0);
+    store16(entry(page, slot) + sizeof(std::uint16_t), 0);
+}
+
+void SlottedPage::compact(char *page) {
+    char data[FileManager::USABLE_PAGE_SIZE];
+    std::size_t end = FileManager::USABLE_PAGE_SIZE;
+    int n = numSlots(page);
+    for (int i = 0; i < n; ++i) {
+        std::uint16_t offset = load16(entry(page, i));
+        if (offset == 0) continue;
+        std::size_t len = recordLength(page, i);
+        end -= len;
+        std::memcpy(data + end, page + offset, len);
+        store16(entry(page, i), end);
+    }
+    std::memcpy(page + end, data + end, FileManager::USABLE_PAGE_SIZE - end);
+    setDataStart(page, end);
+}
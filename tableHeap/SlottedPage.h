@@ -0,0 +1,49 @@
+// File: SlottedPage.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "FileManager.h"
+
+// Layout of a heap page holding variable-length records:
+//
+//   [numSlots:u16][dataStart:u16][slot directory ->   ...   <- record data]
+//
+// The slot directory grows up from the header, one (offset, length) entry
+// per slot; records are packed down from USABLE_PAGE_SIZE. dataStart is the
+// lowest record byte, with 0 standing for "no records yet", so an all-zero
+// page is a valid empty page. A dead (deleted or never used) slot has
+// offset 0; slot numbers stay stable for the life of the page.
+//
+// Deleting or shrinking a record leaves a hole; holes are reclaimed by
+// compacting the page when a record would not fit in the contiguous gap
+// otherwise. Callers hold the page's write latch for every mutation.
+class SlottedPage {
+public:
+    static constexpr std::size_t HEADER_SIZE = 2 * sizeof(std::uint16_t);
+    static constexpr std::size_t ENTRY_SIZE = 2 * sizeof(std::uint16_t);
+    // Free space of an empty page
+    static constexpr std::size_t CAPACITY = FileManager::USABLE_PAGE_SIZE - HEADER_SIZE;
+
+    static int numSlots(const char *page);
+    // Record bytes of a live slot, or nullptr if the slot is dead or past
+    // the directory
+    static const char *record(const char *page, int slot);
+    static std::size_t recordLength(const char *page, int slot);
+    // Bytes left for records and new directory entries once holes are
+    // compacted away
+    static std::size_t freeSpace(const char *page);
+    // First dead slot, or numSlots if every slot is live
+    static int firstFreeSlot(const char *page);
+
+    // Makes room for a len-byte record in `slot` and returns where to write
+    // it. The slot may be dead, live (its old bytes are released; shrinking
+    // stays in place) or past the directory, which then grows with dead
+    // entries up to it. Compacts the page if that is what it takes. Returns
+    // nullptr, leaving the page untouched, if the record does not fit.
+    static char *allocate(char *page, int slot, std::size_t len);
+    // Marks a slot dead; its bytes become a hole
+    static void erase(char *page, int slot);
+    // Packs live records against the end of the page, closing all holes
+    static void compact(char *page);
+};
@@ -1,88 +1,172 @@
 // File: TableHeap.cpp
 #include "TableHeap.h"
+#include "PageGuard.h"
+#include "SlottedPage.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Header format tag of a table file using PageLayout::SLOTTED ("SLT1");
+// files without a tag are FIXED
+constexpr std::uint32_t SLOTTED_LAYOUT_TAG = 0x534c5431;
+
+} // namespace
 
 TableHeap::TableHeap(FileManager &fm, BufferManager &bm,
                      const std::string &tableFile,
-                     const Schema &schema)
-    : fm_(fm), bm_(bm), schema_(schema) {
+                     const Schema &schema,
+                     PageCompression compression,
+                     PageLayout layout)
+    : fm_(fm), bm_(bm), fsm_(fm, bm, tableFile + ".fsm"), schema_(schema) {
     // Compute sizes
     recordSize_    = schema_.getRecordSize();
     slotSize_      = recordSize_ + 1;  // 1 byte for tombstone
-    maxSlotsPerPage_ =
-        (int)((FileManager::PAGE_SIZE - sizeof(int)) / slotSize_);
 
     // Open or create the table file
-    fileId_ = fm_.openFile(tableFile);
-    // If empty, initialize first page
-    if (fm_.getPageCount(fileId_) == 0) {
+    fileId_ = fm_.openFile(tableFile, compression);
+    // Older files without checksums were filled up to PAGE_SIZE
+    maxSlotsPerPage_ =
+        (int)((fm_.usablePageSize(fileId_) - sizeof(int)) / slotSize_);
+    fm_.setExtentSize(fileId_, HEAP_EXTENT_PAGES);
+    bool fresh = fm_.getPageCount(fileId_) == 0;
+    if (fresh)
+        fm_.setFormatTag(fileId_, layout == PageLayout::SLOTTED ? SLOTTED_LAYOUT_TAG : 0);
+    layout_ = fm_.formatTag(fileId_) == SLOTTED_LAYOUT_TAG ? PageLayout::SLOTTED
+                                                           : PageLayout::FIXED;
+    // If empty, initialize first page (zero slots reads the same in both layouts)
+    if (fresh) {
         int pid = fm_.allocatePage(fileId_);
-        char *page = bm_.fetchPage(fileId_, pid);
-        setNumSlots(page, 0);
-        bm_.markDirty(fileId_, pid);
-        bm_.unpinPage(fileId_, pid);
+        WritePageGuard page(bm_, fileId_, pid);
+        setNumSlots(page.data(), 0);
+        fsm_.set(pid, emptyPageSpace());
+        noteWrite();
     }
 }
 
 RecordID TableHeap::insertRecord(const std::vector<FieldValue> &values) {
-    Record rec(schema_, values);
-    auto buf = rec.serialize();
-    int pageCount = fm_.getPageCount(fileId_);
-    // Try existing pages
-    for (int pid = 0; pid < pageCount; ++pid) {
-        char *page = bm_.fetchPage(fileId_, pid);
-        int numSlots = getNumSlots(page);
-        // Reuse a tombstoned slot
-        for (int i = 0; i < numSlots; ++i) {
-            char *slot = getSlotPtr(page, i);
-            if (!isSlotAlive(slot)) {
-                setSlotAlive(slot, true);
-                std::memcpy(slot + 1, buf.data(), recordSize_);
-                bm_.markDirty(fileId_, pid);
-                bm_.unpinPage(fileId_, pid);
-                return {pid, i};
+    auto buf = encodeRecord(values);
+    int need = spaceNeeded(buf.size());
+    for (;;) {
+        int pageCount = fm_.getPageCount(fileId_);
+        // Every page the map offers either takes the record or is recorded
+        // with less than `need`, so the search ends after at most one visit
+        // per stale entry
+        for (int pid = fsm_.find(insertHint_.load(std::memory_order_relaxed), pageCount, need);
+             pid >= 0; pid = fsm_.find(pid + 1, pageCount, need)) {
+            if (fsm_.get(pid) == FreeSpaceMap::UNKNOWN) {
+                // Look under a read latch first, so a full page is not dirtied
+                int free = freeSpace(ReadPageGuard(bm_, fileId_, pid).data());
+                fsm_.set(pid, free);
+                if (free < need) continue;
             }
+            WritePageGuard page(bm_, fileId_, pid);
+            int slotNum = placeRecord(page.data(), buf.data(), buf.size());
+            // Also corrects the entry if the map was stale or another writer
+            // took the space in between
+            fsm_.set(pid, freeSpace(page.data()));
+            if (slotNum < 0) continue;
+            insertHint_.store(pid, std::memory_order_relaxed);
+            noteWrite();
+            return {pid, slotNum};
         }
-        // Append new slot if space
-        if (numSlots < maxSlotsPerPage_) {
-            setNumSlots(page, numSlots + 1);
-            char *slot = getSlotPtr(page, numSlots);
-            setSlotAlive(slot, true);
-            std::memcpy(slot + 1, buf.data(), recordSize_);
-            bm_.markDirty(fileId_, pid);
-            bm_.unpinPage(fileId_, pid);
-            return {pid, numSlots};
+        // No space: add a page and search again. Appended pages read back
+        // as zeros, i.e. an empty slot directory, so the page is usable (by
+        // any inserter) the moment it exists and is never re-initialized
+        // under a writer that got to it first.
+        int pid = fm_.allocatePage(fileId_);
+        fsm_.set(pid, emptyPageSpace());
+        insertHint_.store(pid, std::memory_order_relaxed);
+    }
+}
+
+std::vector<RecordID> TableHeap::insertBatch(const std::vector<std::vector<FieldValue>> &rows) {
+    // Packed sizes, for SLOTTED
+    std::vector<std::size_t> sizes;
+    for (const auto &values : rows) {
+        Record::validate(schema_, values);
+        if (layout_ == PageLayout::SLOTTED) sizes.push_back(packedSize(values));
+    }
+    std::vector<RecordID> rids;
+    rids.reserve(rows.size());
+    std::size_t next = 0;
+    while (next < rows.size()) {
+        int pid = fm_.allocatePage(fileId_);
+        WritePageGuard page(bm_, fileId_, pid, AccessStrategy::BULK_WRITE);
+        // Fresh pages read as empty, but a concurrent insertRecord may
+        // have found this one first: append after whatever it placed
+        if (layout_ == PageLayout::SLOTTED) {
+            for (; next < rows.size(); ++next) {
+                int slot = SlottedPage::numSlots(page.data());
+                char *dst = SlottedPage::allocate(page.data(), slot, sizes[next]);
+                if (!dst) break;
+                Record::packInto(schema_, rows[next], dst);
+                rids.push_back({pid, slot});
+            }
+        } else {
+            int slot = getNumSlots(page.data());
+            for (; slot < maxSlotsPerPage_ && next < rows.size(); ++slot, ++next) {
+                char *slotPtr = getSlotPtr(page.data(), slot);
+                Record::serializeInto(schema_, rows[next], slotPtr + 1);
+                setSlotAlive(slotPtr, true);
+                rids.push_back({pid, slot});
+            }
+            setNumSlots(page.data(), slot);
         }
-        bm_.unpinPage(fileId_, pid);
+        fsm_.set(pid, freeSpace(page.data()));
+        noteWrite();
     }
-    // No space: allocate new page
-    int pid = fm_.allocatePage(fileId_);
-    char *page = bm_.fetchPage(fileId_, pid);
-    setNumSlots(page, 1);
-    char *slot = getSlotPtr(page, 0);
+    return rids;
+}
+
+int TableHeap::freeSpace(const char *page) const {
+    if (layout_ == PageLayout::SLOTTED) return static_cast<int>(SlottedPage::freeSpace(page));
+    int numSlots = getNumSlots(page);
+    int free = maxSlotsPerPage_ - numSlots;
+    for (int i = 0; i < numSlots; ++i) {
+        if (!isSlotAlive(getSlotPtr(page, i))) ++free;
+    }
+    return free;
+}
+
+int TableHeap::emptyPageSpace() const {
+    if (layout_ == PageLayout::SLOTTED) return static_cast<int>(SlottedPage::CAPACITY);
+    return maxSlotsPerPage_;
+}
+
+int TableHeap::spaceNeeded(std::size_t len) const {
+    if (layout_ == PageLayout::SLOTTED) return static_cast<int>(len + SlottedPage::ENTRY_SIZE);
+    return 1;
+}
+
+int TableHeap::placeRecord(char *page, const char *recordBytes, std::size_t len) {
+    if (layout_ == PageLayout::SLOTTED) {
+        int slotNum = SlottedPage::firstFreeSlot(page);
+        return storeAt(page, slotNum, recordBytes, len) ? slotNum : -1;
+    }
+    int numSlots = getNumSlots(page);
+    // Reuse a tombstoned slot
+    int slotNum = 0;
+    while (slotNum < numSlots && isSlotAlive(getSlotPtr(page, slotNum))) ++slotNum;
+    if (slotNum == numSlots) {
+        // Append new slot if space
+        if (numSlots >= maxSlotsPerPage_) return -1;
+        setNumSlots(page, numSlots + 1);
+    }
+    char *slot = getSlotPtr(page, slotNum);
     setSlotAlive(slot, true);
-    std::memcpy(slot + 1, buf.data(), recordSize_);
-    bm_.markDirty(fileId_, pid);
-    bm_.unpinPage(fileId_, pid);
-    return {pid, 0};
+    std::memcpy(slot + 1, recordBytes, recordSize_);
+    return slotNum;
 }
 
 bool TableHeap::deleteRecord(const RecordID &rid) {
     if (rid.pageId < 0 || rid.slotNum < 0) return false;
     if (rid.pageId >= fm_.getPageCount(fileId_)) return false;
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    int numSlots = getNumSlots(page);
-    if (rid.slotNum >= numSlots) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        return false;
-    }
-    char *slot = getSlotPtr(page, rid.slotNum);
-    if (!isSlotAlive(slot)) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        return false;
-    }
-    setSlotAlive(slot, false);
-    bm_.markDirty(fileId_, rid.pageId);
-    bm_.unpinPage(fileId_, rid.pageId);
+    WritePageGuard page(bm_, fileId_, rid.pageId);
+    if (!liveRecord(page.data(), rid.slotNum)) return false;
+    eraseSlot(page.data(), rid.slotNum);
+    fsm_.set(rid.pageId, freeSpace(page.data()));
+    noteWrite();
     return true;
 }
 
@@ -90,55 +174,142 @@ bool TableHeap::updateRecord(const RecordID &rid,
                              const std::vector<FieldValue> &values) {
     if (rid.pageId < 0 || rid.slotNum < 0) return false;
     if (rid.pageId >= fm_.getPageCount(fileId_)) return false;
-    Record rec(schema_, values);
-    auto buf = rec.serialize();
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    int numSlots = getNumSlots(page);
-    if (rid.slotNum >= numSlots) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        return false;
-    }
-    char *slot = getSlotPtr(page, rid.slotNum);
-    if (!isSlotAlive(slot)) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        return false;
-    }
-    std::memcpy(slot + 1, buf.data(), recordSize_);
-    bm_.markDirty(fileId_, rid.pageId);
-    bm_.unpinPage(fileId_, rid.pageId);
+    auto buf = encodeRecord(values);
+    WritePageGuard page(bm_, fileId_, rid.pageId);
+    if (!liveRecord(page.data(), rid.slotNum)) return false;
+    if (!storeAt(page.data(), rid.slotNum, buf.data(), buf.size()))
+        throw std::runtime_error("Updated record does not fit on its page");
+    fsm_.set(rid.pageId, freeSpace(page.data()));
+    noteWrite();
     return true;
 }
 
-std::vector<RecordID> TableHeap::tableScan() {
+TableHeap::Cursor TableHeap::scan(AccessStrategy strategy) const {
+    return Cursor(*this, strategy);
+}
+
+std::vector<RecordID> TableHeap::tableScan(AccessStrategy strategy) {
     std::vector<RecordID> results;
-    int pageCount = fm_.getPageCount(fileId_);
-    for (int pid = 0; pid < pageCount; ++pid) {
-        char *page = bm_.fetchPage(fileId_, pid);
-        int numSlots = getNumSlots(page);
-        for (int i = 0; i < numSlots; ++i) {
-            char *slot = getSlotPtr(page, i);
-            if (isSlotAlive(slot)) results.push_back({pid, i});
+    for (Cursor c = scan(strategy); c.next();) results.push_back(c.rid());
+    return results;
+}
+
+TableHeap::Cursor::Cursor(const TableHeap &heap, AccessStrategy strategy)
+    : heap_(&heap), strategy_(strategy), pageCount_(heap.fm_.getPageCount(heap.fileId_)) {
+    // Full scans are strictly sequential: let readahead run from page 0
+    heap.fm_.beginSequentialScan(heap.fileId_);
+    try {
+        mapped_ = heap.acquireMapping();
+        if (!mapped_) {
+            copy_ = std::make_unique<char[]>(FileManager::PAGE_SIZE);
+            heap.bm_.prefetchRange(heap.fileId_, 0, std::min(SCAN_PREFETCH_PAGES, pageCount_),
+                                   strategy);
         }
-        bm_.unpinPage(fileId_, pid);
+    } catch (...) {
+        // No destructor runs for a half-built cursor: end the scan here
+        finish();
+        throw;
     }
-    return results;
 }
 
-Record TableHeap::getRecord(const RecordID &rid) const {
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    int numSlots = getNumSlots(page);
-    if (rid.slotNum < 0 || rid.slotNum >= numSlots) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        throw std::runtime_error("Invalid RecordID: slot out of range");
+TableHeap::Cursor::~Cursor() { finish(); }
+
+TableHeap::Cursor::Cursor(Cursor &&other) noexcept
+    : heap_(std::exchange(other.heap_, nullptr)),
+      strategy_(other.strategy_),
+      mapped_(std::exchange(other.mapped_, false)),
+      pageCount_(other.pageCount_),
+      numSlots_(other.numSlots_),
+      rid_(other.rid_),
+      slotOffset_(other.slotOffset_),
+      page_(other.page_),
+      copy_(std::move(other.copy_)) {}
+
+TableHeap::Cursor &TableHeap::Cursor::operator=(Cursor &&other) noexcept {
+    if (this != &other) {
+        finish();
+        heap_ = std::exchange(other.heap_, nullptr);
+        strategy_ = other.strategy_;
+        mapped_ = std::exchange(other.mapped_, false);
+        pageCount_ = other.pageCount_;
+        numSlots_ = other.numSlots_;
+        rid_ = other.rid_;
+        slotOffset_ = other.slotOffset_;
+        page_ = other.page_;
+        copy_ = std::move(other.copy_);
     }
-    char *slot = getSlotPtr(page, rid.slotNum);
-    if (!isSlotAlive(slot)) {
-        bm_.unpinPage(fileId_, rid.pageId);
-        throw std::runtime_error("Attempt to read deleted record");
+    return *this;
+}
+
+bool TableHeap::Cursor::next() {
+    if (!heap_) return false;
+    for (;;) {
+        // Next live slot on the current page
+        while (page_ && ++rid_.slotNum < numSlots_) {
+            const char *rec = heap_->liveRecord(page_, rid_.slotNum);
+            if (rec) {
+                slotOffset_ = static_cast<std::size_t>(rec - page_);
+                return true;
+            }
+        }
+        if (rid_.pageId + 1 >= pageCount_) {
+            finish();
+            return false;
+        }
+        loadPage(rid_.pageId + 1);
     }
-    Record rec = Record::deserialize(schema_, slot + 1);
-    bm_.unpinPage(fileId_, rid.pageId);
-    return rec;
+}
+
+void TableHeap::Cursor::loadPage(int pageId) {
+    rid_ = {pageId, -1};
+    if (mapped_) {
+        page_ = heap_->mappedPage(pageId);
+    } else {
+        if (pageId + SCAN_PREFETCH_PAGES < pageCount_)
+            heap_->bm_.prefetchPage(heap_->fileId_, pageId + SCAN_PREFETCH_PAGES, strategy_);
+        ReadPageGuard page(heap_->bm_, heap_->fileId_, pageId, strategy_);
+        std::memcpy(copy_.get(), page.data(), FileManager::PAGE_SIZE);
+        page_ = copy_.get();
+    }
+    numSlots_ = page_ ? heap_->slotCount(page_) : 0;
+}
+
+Record TableHeap::Cursor::record() const {
+    return heap_->decodeRecord(recordData());
+}
+
+void TableHeap::Cursor::finish() {
+    if (!heap_) return;
+    heap_->fm_.endSequentialScan(heap_->fileId_);
+    if (mapped_) heap_->releaseMapping();
+    mapped_ = false;
+    heap_ = nullptr;
+    page_ = nullptr;
+}
+
+Record TableHeap::getRecord(const RecordID &rid, AccessStrategy strategy) const {
+    if (acquireMapping()) {
+        // Held across the decode: setMappedReads(false) must not unmap
+        // the page under us
+        try {
+            const char *page = mappedPage(rid.pageId);
+            if (!page) throw std::runtime_error("Invalid RecordID: page out of range");
+            Record rec = decodeRecord(checkedRecord(page, rid.slotNum));
+            releaseMapping();
+            return rec;
+        } catch (...) {
+            releaseMapping();
+            throw;
+        }
+    }
+    ReadPageGuard page(bm_, fileId_, rid.pageId, strategy);
+    return decodeRecord(checkedRecord(page.data(), rid.slotNum));
+}
+
+void TableHeap::prefetchPage(int pageId, AccessStrategy strategy) const {
+    // Only a hint: the mapping itself is never touched here
+    if (mappedReads_ || pageId < 0 || pageId >= fm_.getPageCount(fileId_)) return;
+    bm_.prefetchPage(fileId_, pageId, strategy);
 }
 
 // --- WAL/Recovery methods ---
@@ -146,45 +317,140 @@ Record TableHeap::getRecord(const RecordID &rid) const {
 void TableHeap::insertAt(const RecordID &rid,
                          const std::vector<FieldValue> &values)
 {
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    int numSlots = getNumSlots(page);
-    // grow slot count if needed
-    if (rid.slotNum >= numSlots) {
-        setNumSlots(page, rid.slotNum + 1);
-    }
-    char *slot = getSlotPtr(page, rid.slotNum);
-    setSlotAlive(slot, true);
-    Record rec(schema_, values);
-    auto buf = rec.serialize();
-    std::memcpy(slot + 1, buf.data(), recordSize_);
-    bm_.markDirty(fileId_, rid.pageId);
-    bm_.unpinPage(fileId_, rid.pageId);
+    auto buf = encodeRecord(values);
+    WritePageGuard page(bm_, fileId_, rid.pageId);
+    // grows the slot count if needed
+    if (!storeAt(page.data(), rid.slotNum, buf.data(), buf.size()))
+        throw std::runtime_error("Replayed record does not fit on its page");
+    fsm_.set(rid.pageId, freeSpace(page.data()));
+    noteWrite();
 }
 
 void TableHeap::deleteAt(const RecordID &rid)
 {
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    char *slot = getSlotPtr(page, rid.slotNum);
-    setSlotAlive(slot, false);
-    bm_.markDirty(fileId_, rid.pageId);
-    bm_.unpinPage(fileId_, rid.pageId);
+    WritePageGuard page(bm_, fileId_, rid.pageId);
+    eraseSlot(page.data(), rid.slotNum);
+    fsm_.set(rid.pageId, freeSpace(page.data()));
+    noteWrite();
 }
 
 void TableHeap::updateAt(const RecordID &rid,
                          const std::vector<FieldValue> &values)
 {
-    char *page = bm_.fetchPage(fileId_, rid.pageId);
-    char *slot = getSlotPtr(page, rid.slotNum);
-    Record rec(schema_, values);
-    auto buf = rec.serialize();
-    std::memcpy(slot + 1, buf.data(), recordSize_);
-    bm_.markDirty(fileId_, rid.pageId);
-    bm_.unpinPage(fileId_, rid.pageId);
+    auto buf = encodeRecord(values);
+    WritePageGuard page(bm_, fileId_, rid.pageId);
+    if (!storeAt(page.data(), rid.slotNum, buf.data(), buf.size()))
+        throw std::runtime_error("Replayed record does not fit on its page");
+    fsm_.set(rid.pageId, freeSpace(page.data()));
+    noteWrite();
+}
+
+void TableHeap::setMappedReads(bool enabled) {
+    if (enabled && fm_.isCompressed(fileId_))
+        throw std::runtime_error("Mapped reads need an uncompressed table file");
+    std::lock_guard<std::mutex> guard(mapUsersLatch_);
+    if (mappedReads_ && !enabled) {
+        // Open cursors still hold pointers into the mapping
+        if (mapUsers_ > 0) unmapPending_ = true;
+        else fm_.unmapFile(fileId_);
+    }
+    if (enabled) unmapPending_ = false;
+    mappedReads_ = enabled;
+    // Anything written through the pool so far may not be on disk yet
+    mapStale_ = enabled;
+}
+
+bool TableHeap::acquireMapping() const {
+    std::lock_guard<std::mutex> guard(mapUsersLatch_);
+    if (!mappedReads_) return false;
+    ++mapUsers_;
+    return true;
+}
+
+void TableHeap::releaseMapping() const {
+    std::lock_guard<std::mutex> guard(mapUsersLatch_);
+    if (--mapUsers_ == 0 && unmapPending_) {
+        unmapPending_ = false;
+        fm_.unmapFile(fileId_);
+    }
 }
 
 // --- Private helpers ---
 
-int TableHeap::getNumSlots(char *pageData) const {
+const char *TableHeap::mappedPage(int pageId) const {
+    // Clear the flag before flushing, so a write landing during the flush
+    // sets it again instead of being forgotten
+    if (mapStale_.exchange(false)) bm_.flushFile(fileId_);
+    return fm_.mapPage(fileId_, pageId);
+}
+
+int TableHeap::slotCount(const char *pageData) const {
+    if (layout_ == PageLayout::SLOTTED) return SlottedPage::numSlots(pageData);
+    return getNumSlots(pageData);
+}
+
+const char *TableHeap::liveRecord(const char *pageData, int slotIdx) const {
+    if (layout_ == PageLayout::SLOTTED) return SlottedPage::record(pageData, slotIdx);
+    if (slotIdx < 0 || slotIdx >= getNumSlots(pageData)) return nullptr;
+    const char *slot = getSlotPtr(pageData, slotIdx);
+    return isSlotAlive(slot) ? slot + 1 : nullptr;
+}
+
+const char *TableHeap::checkedRecord(const char *pageData, int slotIdx) const {
+    if (slotIdx < 0 || slotIdx >= slotCount(pageData))
+        throw std::runtime_error("Invalid RecordID: slot out of range");
+    const char *rec = liveRecord(pageData, slotIdx);
+    if (!rec)
+        throw std::runtime_error("Attempt to read deleted record");
+    return rec;
+}
+
+std::vector<char> TableHeap::encodeRecord(const std::vector<FieldValue> &values) const {
+    if (layout_ == PageLayout::FIXED) return Record(schema_, values).serialize();
+    Record::validate(schema_, values);
+    std::vector<char> buf(packedSize(values));
+    Record::packInto(schema_, values, buf.data());
+    return buf;
+}
+
+Record TableHeap::decodeRecord(const char *recordBytes) const {
+    if (layout_ == PageLayout::SLOTTED) return Record::unpack(schema_, recordBytes);
+    return Record::deserialize(schema_, recordBytes);
+}
+
+RecordView TableHeap::viewRecord(const char *recordBytes) const {
+    return RecordView(schema_, recordBytes, layout_ == PageLayout::SLOTTED
+                                                ? RecordView::Format::PACKED
+                                                : RecordView::Format::FIXED);
+}
+
+std::size_t TableHeap::packedSize(const std::vector<FieldValue> &values) const {
+    std::size_t size = Record::packedSize(schema_, values);
+    if (size + SlottedPage::ENTRY_SIZE > SlottedPage::CAPACITY)
+        throw std::runtime_error("Record too large for a page");
+    return size;
+}
+
+bool TableHeap::storeAt(char *pageData, int slotIdx, const char *recordBytes, std::size_t len) {
+    if (layout_ == PageLayout::SLOTTED) {
+        char *dst = SlottedPage::allocate(pageData, slotIdx, len);
+        if (!dst) return false;
+        std::memcpy(dst, recordBytes, len);
+        return true;
+    }
+    if (slotIdx >= getNumSlots(pageData)) setNumSlots(pageData, slotIdx + 1);
+    char *slot = getSlotPtr(pageData, slotIdx);
+    setSlotAlive(slot, true);
+    std::memcpy(slot + 1, recordBytes, recordSize_);
+    return true;
+}
+
+void TableHeap::eraseSlot(char *pageData, int slotIdx) {
+    if (layout_ == PageLayout::SLOTTED) SlottedPage::erase(pageData, slotIdx);
+    else setSlotAlive(getSlotPtr(pageData, slotIdx), false);
+}
+
+int TableHeap::getNumSlots(const char *pageData) const {
     int num;
     std::memcpy(&num, pageData, sizeof(num));
     return num;
@@ -198,7 +464,11 @@ char *TableHeap::getSlotPtr(char *pageData, int slotIdx) const {
     return pageData + sizeof(int) + slotIdx * slotSize_;
 }
 
-bool TableHeap::isSlotAlive(char *slotPtr) const {
+const char *TableHeap::getSlotPtr(const char *pageData, int slotIdx) const {
+    return pageData + sizeof(int) + slotIdx * slotSize_;
+}
+
+bool TableHeap::isSlotAlive(const char *slotPtr) const {
     return slotPtr[0] != 0;
 }
 
@@ -1,14 +1,19 @@
 // File: TableHeap.h
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <cstring>
 #include <stdexcept>
 #include "Schema.h"
 #include "Record.h"
+#include "RecordView.h"
 #include "BufferManager.h"
 #include "FileManager.h"
+#include "FreeSpaceMap.h"
 
 // Identifier for a record within a table
 struct RecordID {
@@ -16,24 +21,67 @@ struct RecordID {
     int slotNum;
 };
 
+// How a table lays out records on its pages
+enum class PageLayout {
+    // Fixed-width slots; STRING values are padded to their column length
+    FIXED,
+    // Slot directory of (offset, length) entries over variable-length
+    // records (see SlottedPage), so STRINGs only take the bytes they use
+    SLOTTED
+};
+
 class TableHeap {
 public:
-    // Open or create a table file and initialize schema
+    class Cursor;
+
+    // Open or create a table file and initialize schema. `compression` and
+    // `layout` only take effect when the file is created; an existing file
+    // keeps the layout recorded in its header.
     TableHeap(FileManager &fm, BufferManager &bm,
-              const std::string &tableFile, const Schema &schema);
+              const std::string &tableFile, const Schema &schema,
+              PageCompression compression = PageCompression::NONE,
+              PageLayout layout = PageLayout::FIXED);
     ~TableHeap() = default;
 
-    // Insert a record; returns its RecordID
+    PageLayout layout() const { return layout_; }
+
+    // Insert a record; returns its RecordID. The table's free-space map
+    // (<tableFile>.fsm) points it at a page with room, so inserts do not
+    // visit full pages.
     RecordID insertRecord(const std::vector<FieldValue> &values);
+    // Bulk load: appends the rows to freshly allocated pages, filling each
+    // page in one go (no free-slot search, records serialized straight
+    // into the slots) through the pool's BULK_WRITE ring. Every row is
+    // validated before anything is written. Returns the RecordIDs in row
+    // order; rows on the same page have consecutive slots.
+    std::vector<RecordID> insertBatch(const std::vector<std::vector<FieldValue>> &rows);
     // Delete a record by marking it tombstoned
     bool deleteRecord(const RecordID &rid);
-    // Update an existing record in-place
+    // Update an existing record in-place. On a slotted page a grown record
+    // may compact the page; throws if it no longer fits on its page.
     bool updateRecord(const RecordID &rid,
                       const std::vector<FieldValue> &values);
-    // Scan all alive records and return their RecordIDs
-    std::vector<RecordID> tableScan();
-    // Fetch a record by RecordID
-    Record getRecord(const RecordID &rid) const;
+    // Streaming scan over the live records, in page order. Pages go through
+    // the pool's BULK_READ ring by default so a scan leaves the cache alone.
+    Cursor scan(AccessStrategy strategy = AccessStrategy::BULK_READ) const;
+    // Scan all alive records and return their RecordIDs (built on scan())
+    std::vector<RecordID> tableScan(AccessStrategy strategy = AccessStrategy::BULK_READ);
+    // Fetch a record by RecordID; callers walking a scan's RecordIDs pass
+    // the scan's strategy
+    Record getRecord(const RecordID &rid,
+                     AccessStrategy strategy = AccessStrategy::NORMAL) const;
+    // Start loading a page into the pool ahead of a getRecord/update on it
+    // (no-op under mapped reads or past the end of the file)
+    void prefetchPage(int pageId,
+                      AccessStrategy strategy = AccessStrategy::NORMAL) const;
+
+    // Serve scans and record fetches from a read-only mmap of the table file
+    // instead of the buffer pool, so reporting queries over cold, mostly
+    // static tables don't evict the OLTP working set. Writes still go
+    // through the pool and are flushed before the next mapped read.
+    // Not available on compressed tables. Turning it off while scans are
+    // still reading the mapping leaves the unmap to the last of them.
+    void setMappedReads(bool enabled);
 
     // --- WAL/Recovery methods ---
     // Replays an insert exactly at (pageId, slotNum)
@@ -46,18 +94,122 @@ public:
                   const std::vector<FieldValue> &values);
 
 private:
+    // Heap files grow in 2 MiB extents so bulk loads rarely hit fallocate
+    static constexpr int HEAP_EXTENT_PAGES = 256;
+    // Pages a pool scan keeps in flight ahead of itself; well under the
+    // BULK_READ ring so prefetched pages are not recycled before use
+    static constexpr int SCAN_PREFETCH_PAGES = 8;
+
     FileManager &fm_;
     BufferManager &bm_;
+    FreeSpaceMap fsm_;
+    // Page the last insert went to; the next one looks there first
+    std::atomic<int> insertHint_{0};
     int fileId_;
+    PageLayout layout_ = PageLayout::FIXED;
     Schema schema_;
     std::size_t recordSize_;     // bytes for record payload
     std::size_t slotSize_;       // 1 byte tombstone + recordSize_
-    int maxSlotsPerPage_;        // computed from PAGE_SIZE
+    int maxSlotsPerPage_;        // computed from the file's usable page size
+    std::atomic<bool> mappedReads_{false};
+    mutable std::atomic<bool> mapStale_{false};  // pool holds writes the mapping lacks
+    // Cursors and lookups reading pages straight from the mapping; turning
+    // mapped reads off while any are active defers the unmap to the last one
+    mutable std::mutex mapUsersLatch_;
+    mutable int mapUsers_ = 0;
+    mutable bool unmapPending_ = false;
+
+    // Mapped view of a page, flushing pending writes first
+    const char *mappedPage(int pageId) const;
+    // A cursor or lookup starts/stops using the mapping; acquire returns
+    // false when mapped reads are off
+    bool acquireMapping() const;
+    void releaseMapping() const;
+    // Called after every write through the pool
+    void noteWrite() { if (mappedReads_) mapStale_ = true; }
+
+    // Layout-independent record access. Free space is counted in the unit
+    // the free-space map uses for this layout: slots (tombstoned plus those
+    // still appendable) for FIXED, bytes for SLOTTED.
+    int freeSpace(const char *pageData) const;
+    int emptyPageSpace() const;
+    // Free space a page needs to be worth offering a record of len bytes
+    int spaceNeeded(std::size_t len) const;
+    int slotCount(const char *pageData) const;
+    // Bytes of a live record, or nullptr if the slot is dead or out of range
+    const char *liveRecord(const char *pageData, int slotIdx) const;
+    // liveRecord that throws for a bad RecordID
+    const char *checkedRecord(const char *pageData, int slotIdx) const;
+    // Validates and encodes values in this table's record format
+    std::vector<char> encodeRecord(const std::vector<FieldValue> &values) const;
+    Record decodeRecord(const char *recordBytes) const;
+    RecordView viewRecord(const char *recordBytes) const;
+    // Packed size of validated values; throws if they cannot fit a page
+    std::size_t packedSize(const std::vector<FieldValue> &values) const;
+    // Stores the record in a free slot; returns the slot or -1 if full
+    int placeRecord(char *pageData, const char *recordBytes, std::size_t len);
+    // Writes the record into slotIdx (live, dead or past the last slot);
+    // false if a slotted page has no room for it
+    bool storeAt(char *pageData, int slotIdx, const char *recordBytes, std::size_t len);
+    void eraseSlot(char *pageData, int slotIdx);
 
-    // Page layout helpers
-    int    getNumSlots(char *pageData) const;
+    // FIXED page layout helpers
+    int    getNumSlots(const char *pageData) const;
     void   setNumSlots(char *pageData, int numSlots);
     char*  getSlotPtr(char *pageData, int slotIdx) const;
-    bool   isSlotAlive(char *slotPtr) const;
+    const char *getSlotPtr(const char *pageData, int slotIdx) const;
+    bool   isSlotAlive(const char *slotPtr) const;
     void   setSlotAlive(char *slotPtr, bool alive) const;
 };
+
+// Forward-only cursor over a table's live records. Each page is pinned and
+// read-latched once, just long enough to copy it into the cursor; records
+// are then served from the copy, so memory use is one page whatever the
+// table size, and no latch is held while the caller works on a record.
+// Pages appended after the cursor was opened are not visited. The heap
+// must outlive the cursor. Move-only; a default-constructed cursor is at
+// its end.
+class TableHeap::Cursor {
+public:
+    Cursor() = default;
+    ~Cursor();
+    Cursor(Cursor &&other) noexcept;
+    Cursor &operator=(Cursor &&other) noexcept;
+    Cursor(const Cursor &) = delete;
+    Cursor &operator=(const Cursor &) = delete;
+
+    // Moves to the next live record; false once the table is exhausted
+    bool next();
+    // The current record (valid after next() returned true)
+    const RecordID &rid() const { return rid_; }
+    // The current record's fields read in place, without copying; valid
+    // until the next call to next(). Scans that filter or aggregate should
+    // use this and only materialize (view().values()) what they keep.
+    RecordView view() const { return heap_->viewRecord(recordData()); }
+    // Materialized copy of the current record
+    Record record() const;
+    // Bytes of the current record in the table's format (Record::serialize
+    // for FIXED, Record::packInto for SLOTTED), valid until the next call
+    // to next()
+    const char *recordData() const { return page_ + slotOffset_; }
+
+private:
+    friend class TableHeap;
+    Cursor(const TableHeap &heap, AccessStrategy strategy);
+    // Copies (or maps) pageId and resets the slot position
+    void loadPage(int pageId);
+    // Restores the file's default readahead once the scan is over
+    void finish();
+
+    const TableHeap *heap_ = nullptr;
+    AccessStrategy strategy_ = AccessStrategy::BULK_READ;
+    // Reads from the table's mapping (fixed when the cursor opens)
+    bool mapped_ = false;
+    int pageCount_ = 0;
+    int numSlots_ = 0;
+    RecordID rid_{-1, -1};
+    std::size_t slotOffset_ = 0;
+    // Current page: copy_ for pool reads, the mapping for mapped reads
+    const char *page_ = nullptr;
+    std::unique_ptr<char[]> copy_;
+};
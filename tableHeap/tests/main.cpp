@@ -0,0 +1,158 @@
+// File: main.cpp
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "FileManager.h"
+#include "BufferManager.h"
+#include "SlottedPage.h"
+#include "TableHeap.h"
+#include "BPlusTree.h"
+
+static int failures = 0;
+
+static void check(bool ok, const std::string &what) {
+    std::cout << (ok ? "[OK] " : "[FAIL] ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+// Writes a record whose bytes are all `tag`
+static bool put(char *page, int slot, std::size_t len, char tag) {
+    char *dst = SlottedPage::allocate(page, slot, len);
+    if (!dst) return false;
+    std::memset(dst, tag, len);
+    return true;
+}
+
+// True if the slot is live, len bytes long and filled with `tag`
+static bool holds(const char *page, int slot, std::size_t len, char tag) {
+    const char *rec = SlottedPage::record(page, slot);
+    if (!rec || SlottedPage::recordLength(page, slot) != len) return false;
+    return std::all_of(rec, rec + len, [tag](char c) { return c == tag; });
+}
+
+static void slottedPageTests() {
+    std::vector<char> page(FileManager::PAGE_SIZE, 0);
+    char *p = page.data();
+
+    // 1) An all-zero page is empty
+    check(SlottedPage::numSlots(p) == 0 &&
+          SlottedPage::freeSpace(p) == SlottedPage::CAPACITY, "zero page is empty");
+
+    // 2) Grow a record, then shrink it in place
+    put(p, 0, 100, 'a');
+    put(p, 1, 40, 'b');
+    check(put(p, 0, 300, 'A') && holds(p, 0, 300, 'A') && holds(p, 1, 40, 'b'),
+          "grow record");
+    const char *before = SlottedPage::record(p, 0);
+    check(SlottedPage::allocate(p, 0, 120) == before && holds(p, 0, 120, 'A'),
+          "shrink record in place");
+    check(SlottedPage::freeSpace(p) ==
+          SlottedPage::CAPACITY - 2 * SlottedPage::ENTRY_SIZE - 120 - 40,
+          "shrink frees the tail");
+
+    // 3) Erase leaves a dead slot that is reused first
+    SlottedPage::erase(p, 0);
+    check(SlottedPage::record(p, 0) == nullptr && SlottedPage::firstFreeSlot(p) == 0,
+          "erase frees slot");
+
+    // 4) Compact closes holes and keeps every live record
+    std::fill(page.begin(), page.end(), 0);
+    int n = 0;
+    while (put(p, n, 100, static_cast<char>('a' + n % 26))) ++n;
+    for (int i = 1; i < n; i += 2) SlottedPage::erase(p, i);
+    std::size_t free = SlottedPage::freeSpace(p);
+    SlottedPage::compact(p);
+    bool kept = SlottedPage::freeSpace(p) == free;
+    for (int i = 0; i < n; ++i) {
+        kept = kept && (i % 2 ? SlottedPage::record(p, i) == nullptr
+                              : holds(p, i, 100, static_cast<char>('a' + i % 26)));
+    }
+    check(kept, "compact keeps live records");
+    // The whole free space is now one gap
+    check(put(p, 1, free, 'z') && SlottedPage::freeSpace(p) == 0 && holds(p, 1, free, 'z'),
+          "compacted gap is usable");
+
+    // 5) A record that only fits once holes are compacted
+    std::fill(page.begin(), page.end(), 0);
+    n = 0;
+    while (put(p, n, 100, static_cast<char>('a' + n % 26))) ++n;
+    SlottedPage::erase(p, 1);
+    SlottedPage::erase(p, 2);
+    check(put(p, 1, 180, 'Z') && holds(p, 1, 180, 'Z') && holds(p, n - 1, 100,
+          static_cast<char>('a' + (n - 1) % 26)), "allocate compacts holes");
+
+    // 6) Growing the slot directory past the lowest record moves the record
+    //    out of its way instead of overwriting it
+    std::fill(page.begin(), page.end(), 0);
+    n = 0;
+    while (put(p, n, 100, static_cast<char>('a' + n % 26))) ++n;
+    for (int i = 0; i < 3; ++i) SlottedPage::erase(p, i);
+    const int far = n + 40;
+    check(put(p, far, 50, 'Q'), "directory grows into lowest record");
+    kept = SlottedPage::numSlots(p) == far + 1 && holds(p, far, 50, 'Q');
+    for (int i = 3; i < n; ++i) kept = kept && holds(p, i, 100, static_cast<char>('a' + i % 26));
+    for (int i = n; i < far; ++i) kept = kept && SlottedPage::record(p, i) == nullptr;
+    check(kept, "records survive directory growth");
+
+    // 7) A record that cannot fit leaves the page untouched
+    std::vector<char> copy = page;
+    check(SlottedPage::allocate(p, far + 1, SlottedPage::CAPACITY) == nullptr &&
+          copy == page, "oversized record rejected");
+}
+
+static void bulkLoadTests(FileManager &fm, BufferManager &bm) {
+    const std::string path = "bulkload_test.idx";
+    std::remove(path.c_str());
+    int fid = fm.openFile(path);
+    BPlusTree<int32_t, RecordID> tree(fid, bm);
+
+    // 1) Bulk load shuffled keys into the empty tree; key 7 appears twice
+    const int count = 20000;
+    std::vector<std::pair<int32_t, RecordID>> entries;
+    for (int i = 0; i < count; ++i) entries.push_back({i * 2, RecordID{i, i % 50}});
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(42));
+    entries.push_back({14, RecordID{-1, -1}});
+    tree.bulkLoad(entries);
+
+    // 2) Every key is found, the last duplicate wins, gaps stay missing
+    bool found = true;
+    for (int i = 0; i < count; ++i) {
+        RecordID rid;
+        if (!tree.find(i * 2, rid) || tree.find(i * 2 + 1, rid)) { found = false; break; }
+        if (i != 7 && (rid.pageId != i || rid.slotNum != i % 50)) { found = false; break; }
+    }
+    RecordID dup;
+    check(found && tree.find(14, dup) && dup.pageId == -1, "bulk-loaded keys found");
+
+    // 3) Range scans cross leaf boundaries in key order
+    std::vector<RecordID> range = tree.rangeScan(1001, 9000);
+    bool ordered = range.size() == 4000;
+    for (std::size_t i = 0; ordered && i < range.size(); ++i) {
+        ordered = range[i].pageId == static_cast<int>(501 + i);
+    }
+    check(ordered, "range scan over bulk-loaded tree");
+    check(tree.rangeScan(-10, -1).empty() && tree.rangeScan(0, 0).size() == 1,
+          "range scan edges");
+
+    // 4) Ordinary inserts still work on a bulk-built tree
+    tree.insert(1, RecordID{77, 7});
+    RecordID rid;
+    check(tree.find(1, rid) && rid.pageId == 77 && tree.rangeScan(0, 2).size() == 3,
+          "insert after bulk load");
+}
+
+int main() {
+    FileManager   fm;
+    BufferManager bm(fm, /*poolSize=*/64);
+
+    slottedPageTests();
+    bulkLoadTests(fm, bm);
+
+    std::cout << (failures ? "FAILED: " + std::to_string(failures) : std::string("all passed"))
+              << "\n";
+    return failures ? 1 : 0;
+}